@@ -0,0 +1,495 @@
+/*
+ * Benchmark of the Set operations against std::set, sorted std::vector, and std::flat_set
+ *
+ * Usage: Lab2-bench [--max-size N] [--min-time seconds] [--out file.json]
+ *   --max-size  largest Set size, sizes are 10, 100, ..., up to N (default 10^6, at most 10^8)
+ *   --min-time  each operation is repeated for at least this time (default 0.05 s)
+ *   --out       write the JSON report to a file instead of std::cout
+ *
+ * For each size, density, and overlap ratio two Sets A and B of the same size are generated
+ *   density: number of values / range of the values, e.g. 0.01 means gaps of 100 on average
+ *   overlap: fraction of the values of A that also belong to B
+ *
+ * Reported for each container and operation:
+ *   ns_per_element:  time of one operation divided by the size of the Set, per lookup for is_member
+ *   allocations:     number of calls of operator new during one operation, and bytes requested
+ *   peak_rss_kb:     peak resident memory during the measurement (of the whole process,
+ *                    if the peak cannot be reset, i.e. not on Linux)
+ *
+ * Construction and set-algebra operations also include the destruction of the result
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <compare>
+#include <new>
+#include <limits>
+#include <cassert>
+
+#if __has_include(<flat_set>)
+#include <flat_set>
+#endif
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "set.h"
+
+/* ******************************************* *
+ * Allocation counting                         *
+ * ******************************************* */
+
+// GCC does not see that the replaced operator new uses malloc
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+
+std::atomic<std::size_t> n_allocations{0};
+std::atomic<std::size_t> n_bytes_allocated{0};
+
+}  // namespace
+
+void* operator new(std::size_t n) {
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+    n_bytes_allocated.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n == 0 ? 1 : n)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+/* ******************************************* *
+ * Peak resident memory                        *
+ * ******************************************* */
+
+/*
+ * Reset the peak resident memory of the process, if the system allows it
+ * Return true if it was reset
+ */
+bool reset_peak_rss() {
+#ifdef __linux__
+    std::ofstream clear_refs{"/proc/self/clear_refs"};
+    clear_refs << "5";  // reset the peak resident set size, see man proc
+    return static_cast<bool>(clear_refs.flush());
+#else
+    return false;
+#endif
+}
+
+/*
+ * Return the peak resident memory of the process, in kB
+ */
+std::size_t peak_rss_kb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+    return pmc.PeakWorkingSetSize / 1024;
+#else
+#ifdef __linux__
+    std::ifstream status{"/proc/self/status"};
+    for (std::string line; std::getline(status, line);) {
+        if (line.starts_with("VmHWM:")) {
+            return std::stoull(line.substr(6));
+        }
+    }
+#endif
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss) / 1024;  // bytes on macOS
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+/* ******************************************* *
+ * Input generation                            *
+ * ******************************************* */
+
+/*
+ * Two sorted vectors of n unique values each
+ */
+struct Input {
+    std::vector<int> A;
+    std::vector<int> B;
+    std::vector<int> queries;  // values to look up, half of them in A
+    double density;            // actual density, lower than requested if the int range is too small
+};
+
+/*
+ * Generate n values for A and B, with the given density and overlap ratio
+ * A pool of values is drawn with random gaps of mean 1/density, and each value of the pool
+ * goes to A and B, to A only, or to B only
+ */
+Input generate(std::size_t n, double density, double overlap, std::mt19937_64& rng) {
+    const auto n_both = static_cast<std::size_t>(static_cast<double>(n) * overlap);
+    const std::size_t n_pool = 2 * n - n_both;
+
+    // role of each value of the pool: 0 = both, 1 = A only, 2 = B only
+    std::vector<std::uint8_t> roles(n_pool, 1);
+    std::fill_n(roles.begin(), n_both, std::uint8_t{0});
+    std::fill_n(roles.begin() + static_cast<std::ptrdiff_t>(n), n - n_both, std::uint8_t{2});
+    std::shuffle(roles.begin(), roles.end(), rng);
+
+    // gaps in [1, max_gap], such that all values fit in an int
+    const std::uint64_t range_limit = (std::uint64_t{1} << 32) / n_pool;
+    const auto max_gap = std::clamp<std::uint64_t>(static_cast<std::uint64_t>(2.0 / density) - 1, 1, range_limit);
+    std::uniform_int_distribution<std::uint64_t> gap{1, max_gap};
+
+    Input in;
+    in.A.reserve(n);
+    in.B.reserve(n);
+    in.density = 2.0 / static_cast<double>(max_gap + 1);
+    std::int64_t value = std::numeric_limits<int>::min();
+    for (const std::uint8_t role : roles) {
+        value += static_cast<std::int64_t>(gap(rng));
+        if (role != 2) {
+            in.A.push_back(static_cast<int>(value));
+        }
+        if (role != 1) {
+            in.B.push_back(static_cast<int>(value));
+        }
+    }
+
+    // lookups: values of A and values between the values of A
+    // fewer lookups in large Sets, since Set::is_member is O(n)
+    std::uniform_int_distribution<std::size_t> index{0, n - 1};
+    in.queries.resize(std::clamp<std::size_t>((std::size_t{1} << 24) / n, 16, std::size_t{1} << 16));
+    for (std::size_t i = 0; i < in.queries.size(); ++i) {
+        const int v = in.A[index(rng)];
+        in.queries[i] = (i % 2 == 0) ? v : v + 1 - static_cast<int>(max_gap == 1);
+    }
+    return in;
+}
+
+/* ******************************************* *
+ * Containers under test                       *
+ * ******************************************* */
+
+/*
+ * Subset ordering of two sorted ranges, as Set::operator<=>
+ */
+template <class C>
+std::partial_ordering subset_order(const C& S1, const C& S2) {
+    const bool sub = std::includes(S2.begin(), S2.end(), S1.begin(), S1.end());
+    const bool super = std::includes(S1.begin(), S1.end(), S2.begin(), S2.end());
+    if (sub && super) {
+        return std::partial_ordering::equivalent;
+    }
+    if (sub) {
+        return std::partial_ordering::less;
+    }
+    if (super) {
+        return std::partial_ordering::greater;
+    }
+    return std::partial_ordering::unordered;
+}
+
+struct SetAdapter {
+    using type = Set;
+    static constexpr const char* name = "Set";
+
+    static type build(const std::vector<int>& V) {
+        return Set{V};
+    }
+    static bool contains(const type& S, int v) {
+        return S.is_member(v);
+    }
+    static std::partial_ordering compare(const type& S1, const type& S2) {
+        return S1 <=> S2;
+    }
+    static type set_union(const type& S1, const type& S2) {
+        return S1 + S2;
+    }
+    static type set_intersection(const type& S1, const type& S2) {
+        return S1 * S2;
+    }
+    static type set_difference(const type& S1, const type& S2) {
+        return S1 - S2;
+    }
+};
+
+struct StdSetAdapter {
+    using type = std::set<int>;
+    static constexpr const char* name = "std::set";
+
+    static type build(const std::vector<int>& V) {
+        return type(V.begin(), V.end());
+    }
+    static bool contains(const type& S, int v) {
+        return S.contains(v);
+    }
+    static std::partial_ordering compare(const type& S1, const type& S2) {
+        return subset_order(S1, S2);
+    }
+    static type set_union(const type& S1, const type& S2) {
+        type R;
+        std::set_union(S1.begin(), S1.end(), S2.begin(), S2.end(), std::inserter(R, R.end()));
+        return R;
+    }
+    static type set_intersection(const type& S1, const type& S2) {
+        type R;
+        std::set_intersection(S1.begin(), S1.end(), S2.begin(), S2.end(), std::inserter(R, R.end()));
+        return R;
+    }
+    static type set_difference(const type& S1, const type& S2) {
+        type R;
+        std::set_difference(S1.begin(), S1.end(), S2.begin(), S2.end(), std::inserter(R, R.end()));
+        return R;
+    }
+};
+
+struct VectorAdapter {
+    using type = std::vector<int>;
+    static constexpr const char* name = "sorted std::vector";
+
+    static type build(const std::vector<int>& V) {
+        return V;
+    }
+    static bool contains(const type& S, int v) {
+        return std::binary_search(S.begin(), S.end(), v);
+    }
+    static std::partial_ordering compare(const type& S1, const type& S2) {
+        return subset_order(S1, S2);
+    }
+    static type set_union(const type& S1, const type& S2) {
+        type R;
+        R.reserve(S1.size() + S2.size());
+        std::set_union(S1.begin(), S1.end(), S2.begin(), S2.end(), std::back_inserter(R));
+        return R;
+    }
+    static type set_intersection(const type& S1, const type& S2) {
+        type R;
+        R.reserve(std::min(S1.size(), S2.size()));
+        std::set_intersection(S1.begin(), S1.end(), S2.begin(), S2.end(), std::back_inserter(R));
+        return R;
+    }
+    static type set_difference(const type& S1, const type& S2) {
+        type R;
+        R.reserve(S1.size());
+        std::set_difference(S1.begin(), S1.end(), S2.begin(), S2.end(), std::back_inserter(R));
+        return R;
+    }
+};
+
+#if defined(__cpp_lib_flat_set)
+struct FlatSetAdapter {
+    using type = std::flat_set<int>;
+    static constexpr const char* name = "std::flat_set";
+
+    static type build(const std::vector<int>& V) {
+        return type(std::sorted_unique, V);
+    }
+    static bool contains(const type& S, int v) {
+        return S.contains(v);
+    }
+    static std::partial_ordering compare(const type& S1, const type& S2) {
+        return subset_order(S1, S2);
+    }
+    static type set_union(const type& S1, const type& S2) {
+        return type(std::sorted_unique, VectorAdapter::set_union(S1.keys(), S2.keys()));
+    }
+    static type set_intersection(const type& S1, const type& S2) {
+        return type(std::sorted_unique, VectorAdapter::set_intersection(S1.keys(), S2.keys()));
+    }
+    static type set_difference(const type& S1, const type& S2) {
+        return type(std::sorted_unique, VectorAdapter::set_difference(S1.keys(), S2.keys()));
+    }
+};
+#endif
+
+/* ******************************************* *
+ * Measurement                                 *
+ * ******************************************* */
+
+struct Config {
+    std::size_t max_size = 1'000'000;
+    double min_time = 0.05;  // seconds
+    std::string out;
+};
+
+struct Result {
+    double ns_per_element;
+    std::size_t allocations;
+    std::size_t bytes_allocated;
+    std::size_t peak_rss_kb;
+};
+
+volatile std::size_t sink;  // results are written here, so that the work is not optimized away
+
+/*
+ * Return a value that depends on the contents of S, so that building S cannot be optimized away
+ */
+template <class C>
+std::size_t digest(const C& S) {
+    if (S.begin() == S.end()) {
+        return 0;
+    }
+    return 1 + static_cast<std::size_t>(*S.begin()) + static_cast<std::size_t>(*std::prev(S.end()));
+}
+
+/*
+ * Time f, an operation on n elements, repeated for at least min_time seconds
+ * Allocations are counted during the first call
+ */
+template <class F>
+Result measure(std::size_t n, double min_time, F&& f) {
+    using clock = std::chrono::steady_clock;
+
+    reset_peak_rss();
+    const std::size_t allocs_before = n_allocations.load();
+    const std::size_t bytes_before = n_bytes_allocated.load();
+    sink = f();
+    Result r{0.0, n_allocations.load() - allocs_before, n_bytes_allocated.load() - bytes_before, 0};
+
+    std::size_t reps = 0;
+    const auto start = clock::now();
+    std::chrono::duration<double> elapsed{};
+    do {
+        sink = f();
+        ++reps;
+        elapsed = clock::now() - start;
+    } while (elapsed.count() < min_time);
+
+    r.ns_per_element = elapsed.count() * 1e9 / static_cast<double>(reps * std::max<std::size_t>(n, 1));
+    r.peak_rss_kb = peak_rss_kb();
+    return r;
+}
+
+/*
+ * Write the JSON report incrementally: one object per measurement in "results"
+ */
+class Report {
+public:
+    explicit Report(std::ostream& os) : out{os} {
+        out << "{\n  \"benchmark\": \"Lab2 Set\",\n  \"results\": [";
+    }
+
+    ~Report() {
+        out << "\n  ]\n}\n";
+    }
+
+    void add(const char* container, const char* operation, std::size_t n, double density, double overlap,
+             const Result& r) {
+        out << (first ? "\n" : ",\n") << "    {\"container\": \"" << container << "\", \"operation\": \""
+            << operation << "\", \"size\": " << n << ", \"density\": " << density << ", \"overlap\": " << overlap
+            << ", \"ns_per_element\": " << r.ns_per_element << ", \"allocations\": " << r.allocations
+            << ", \"bytes_allocated\": " << r.bytes_allocated << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+        first = false;
+    }
+
+private:
+    std::ostream& out;
+    bool first = true;
+};
+
+/*
+ * Run all operations of container Adapter on input in
+ */
+template <class Adapter>
+void run(const Input& in, double overlap, const Config& cfg, Report& report) {
+    const std::size_t n = in.A.size();
+    auto record = [&](const char* operation, std::size_t n_elements, auto&& f) {
+        const Result r = measure(n_elements, cfg.min_time, f);
+        report.add(Adapter::name, operation, n, in.density, overlap, r);
+    };
+
+    record("construction", n, [&] { return digest(Adapter::build(in.A)); });
+
+    const typename Adapter::type S1 = Adapter::build(in.A);
+    const typename Adapter::type S2 = Adapter::build(in.B);
+
+    record("copy", n, [&] {
+        const typename Adapter::type C = S1;
+        return digest(C);
+    });
+    record("is_member", in.queries.size(), [&] {
+        std::size_t found = 0;
+        for (const int v : in.queries) {
+            found += Adapter::contains(S1, v);
+        }
+        return found;
+    });
+    record("<=>", n, [&] { return static_cast<std::size_t>(Adapter::compare(S1, S2) < 0); });
+    record("union", n, [&] { return digest(Adapter::set_union(S1, S2)); });
+    record("intersection", n, [&] { return digest(Adapter::set_intersection(S1, S2)); });
+    record("difference", n, [&] { return digest(Adapter::set_difference(S1, S2)); });
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg{argv[i]};
+        if (arg == "--max-size") {
+            cfg.max_size = std::min<std::size_t>(std::stoull(argv[i + 1]), 100'000'000);
+        } else if (arg == "--min-time") {
+            cfg.min_time = std::stod(argv[i + 1]);
+        } else if (arg == "--out") {
+            cfg.out = argv[i + 1];
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!cfg.out.empty()) {
+        file.open(cfg.out);
+        if (!file) {
+            std::cerr << "Cannot write " << cfg.out << "\n";
+            return 1;
+        }
+    }
+
+    std::mt19937_64 rng{2024};
+    {
+        Report report{cfg.out.empty() ? std::cout : file};
+
+        for (std::size_t n = 10; n <= cfg.max_size; n *= 10) {
+            for (const double density : {1.0, 0.01}) {
+                for (const double overlap : {0.0, 0.5, 1.0}) {
+                    std::cerr << "size " << n << ", density " << density << ", overlap " << overlap << "\n";
+                    const Input in = generate(n, density, overlap, rng);
+
+                    run<SetAdapter>(in, overlap, cfg, report);
+                    run<StdSetAdapter>(in, overlap, cfg, report);
+                    run<VectorAdapter>(in, overlap, cfg, report);
+#if defined(__cpp_lib_flat_set)
+                    run<FlatSetAdapter>(in, overlap, cfg, report);
+#endif
+                }
+            }
+        }
+    }
+    assert(Set::get_count_nodes() == 0);
+}
@@ -0,0 +1,74 @@
+#include "bloomfilter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+std::uint64_t hash_key(std::uint64_t key) {
+    return mix64(key + 0x9E3779B97F4A7C15ULL);
+}
+
+}  // namespace
+
+/*
+ * Constructor: create an empty filter
+ * \param expected_values number of keys the filter is sized for
+ * \param fp_rate desired false positive rate, when expected_values keys are inserted
+ */
+BloomFilter::BloomFilter(size_t expected_values, double rate)
+    : max_values{std::max<size_t>(expected_values, 1)}, fp_rate{rate} {
+    assert(rate > 0.0 && rate < 1.0);
+
+    // optimal number of bits per key and of hash functions for a standard Bloom filter
+    const double ln2 = std::log(2.0);
+    const double bits_per_value = -std::log(rate) / (ln2 * ln2);
+    n_hashes = std::clamp(static_cast<int>(std::lround(bits_per_value * ln2)), 1, 16);
+
+    const double n_bits = bits_per_value * static_cast<double>(max_values);
+    const auto n_blocks = static_cast<size_t>(std::ceil(n_bits / 512.0));
+    blocks.resize(std::max<size_t>(n_blocks, 1));
+    clear();
+}
+
+/*
+ * Add key to the filter
+ */
+void BloomFilter::insert(std::uint64_t key) { // O(1)
+    const std::uint64_t h = hash_key(key);
+    Block& b = blocks[block_index(h)];
+
+    // double hashing inside the block: bit i is h1 + i * h2 (mod 512)
+    const auto h1 = static_cast<std::uint32_t>(h);
+    const auto h2 = static_cast<std::uint32_t>(mix64(h)) | 1;
+    for (int i = 0; i < n_hashes; ++i) {
+        const std::uint32_t bit = (h1 + static_cast<std::uint32_t>(i) * h2) & 511;
+        b.words[bit >> 6] |= std::uint64_t{1} << (bit & 63);
+    }
+}
+
+/*
+ * Return false if key was certainly not inserted, otherwise true
+ */
+bool BloomFilter::may_contain(std::uint64_t key) const { // O(1)
+    const std::uint64_t h = hash_key(key);
+    const Block& b = blocks[block_index(h)];
+
+    const auto h1 = static_cast<std::uint32_t>(h);
+    const auto h2 = static_cast<std::uint32_t>(mix64(h)) | 1;
+    for (int i = 0; i < n_hashes; ++i) {
+        const std::uint32_t bit = (h1 + static_cast<std::uint32_t>(i) * h2) & 511;
+        if ((b.words[bit >> 6] & (std::uint64_t{1} << (bit & 63))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Remove all keys from the filter
+ */
+void BloomFilter::clear() {
+    std::fill(blocks.begin(), blocks.end(), Block{});
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * 64-bit mix function (splitmix64 finalizer): every input bit affects every output bit
+ */
+constexpr std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/** Class BloomFilter
+ *
+ * A blocked Bloom filter of 64-bit keys: all bits of a key are set in one 512-bit block,
+ * i.e. one cache line, so a test reads a single cache line
+ * may_contain never returns false for an inserted key, but may return true for
+ * a key not inserted, with a probability close to the false positive rate
+ * Keys cannot be removed: the filter must be rebuilt instead
+ * Keys do not need to be well distributed, e.g. an int can be its own key
+ */
+class BloomFilter {
+public:
+    /*
+     * Constructor: create an empty filter
+     * \param expected_values number of keys the filter is sized for
+     * \param fp_rate desired false positive rate, when expected_values keys are inserted
+     */
+    BloomFilter(size_t expected_values, double fp_rate);
+
+    /*
+     * Add key to the filter
+     */
+    void insert(std::uint64_t key);
+
+    /*
+     * Return false if key was certainly not inserted, otherwise true
+     */
+    bool may_contain(std::uint64_t key) const;
+
+    /*
+     * Remove all keys from the filter
+     */
+    void clear();
+
+    /*
+     * Number of keys the filter is sized for
+     */
+    size_t capacity() const {
+        return max_values;
+    }
+
+    double false_positive_rate() const {
+        return fp_rate;
+    }
+
+private:
+    struct alignas(64) Block {
+        std::uint64_t words[8];
+    };
+
+    std::vector<Block> blocks;
+    int n_hashes;       // bits set per key
+    size_t max_values;  // number of keys the filter is sized for
+    double fp_rate;
+
+    // map the high 32 bits of hash h to a block, without a modulo
+    size_t block_index(std::uint64_t h) const {
+        return static_cast<size_t>(((h >> 32) * blocks.size()) >> 32);
+    }
+};
+
+/*
+ * Counters of the Bloom filter of a Set, to tune the false positive rate
+ *   hits:            the filter passed and the value is in the Set
+ *   misses:          the filter rejected the value, no list traversal
+ *   false_positives: the filter passed but the value is not in the Set
+ */
+struct BloomStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t false_positives = 0;
+};
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+#include "epoch.h"
+
+/** Class to represent a Set of values of type T shared by several threads
+ *
+ * BasicConcurrentSet is implemented as a sorted singly linked list without locks (Harris, Michael):
+ * a Node is erased by first marking its next pointer, which freezes it, and then unlinking it
+ * Marked Nodes met by insert and erase are unlinked on the way
+ * Unlinked Nodes are deleted by the EpochDomain, once no thread can be visiting them
+ *
+ *   is_member is wait-free: it never retries, it only walks the list
+ *   insert and erase are lock-free: a thread retries only if another thread changed the list
+ *
+ * All operations are linearizable, and O(n) as for class Set
+ * cardinality() is exact only when no insert or erase is in progress
+ * Usage for bulk operations: Set S{CS.to_vector()};
+ */
+template <class T, class Compare = std::less<T>>
+class BasicConcurrentSet {
+public:
+    using value_type = T;
+    using value_compare = Compare;
+
+    /*
+     *  Default constructor :create an empty Set
+     */
+    BasicConcurrentSet();
+
+    /*
+     * Constructor to create a Set from a vector of values in any order, possibly with repetitions
+     * The values are sorted and the Nodes are linked in one pass -- O(n log n)
+     */
+    explicit BasicConcurrentSet(const std::vector<T>& list_of_values);
+
+    /*
+     * Destructor: deallocate all Nodes of the list
+     * No other thread may be using the Set
+     */
+    ~BasicConcurrentSet();
+
+    /*
+     * Copying a shared Set is not an atomic operation: use to_vector instead
+     */
+    BasicConcurrentSet(const BasicConcurrentSet&) = delete;
+    BasicConcurrentSet& operator=(const BasicConcurrentSet&) = delete;
+
+    /*
+     * Test whether val belongs to the Set -- wait-free
+     */
+    bool is_member(const T& val) const;
+
+    /*
+     * Add val to the Set -- lock-free
+     * Return true if val was added, false if it already belonged to the Set
+     */
+    bool insert(const T& val);
+
+    /*
+     * Remove val from the Set -- lock-free
+     * Return true if val was removed, false if it did not belong to the Set
+     */
+    bool erase(const T& val);
+
+    bool is_empty() const {
+        return cardinality() == 0;
+    }
+
+    size_t cardinality() const {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * Return the values of the Set in increasing order
+     * Values inserted or erased by other threads during the call may be missing or present
+     */
+    std::vector<T> to_vector() const;
+
+    /*
+     * Return number of existing nodes
+     * Used solely for debug purposes
+     */
+    static int get_count_nodes() {
+        return Node::count_nodes.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * Overloaded operator<<
+     * \param os ostream object where the set S elements are written
+     */
+    friend std::ostream& operator<<(std::ostream& os, const BasicConcurrentSet& S) {
+        const std::vector<T> values = S.to_vector();
+        if (values.empty()) {
+            os << "Set is empty!";
+        } else {
+            os << "{ ";
+            for (const T& v : values) {
+                os << v << " ";
+            }
+            os << "}";
+        }
+        return os;
+    }
+
+private:
+    /*
+     * A Node of the list
+     * The lowest bit of next marks the Node as erased, see is_marked
+     */
+    class Node {
+    public:
+        explicit Node(const T& nodeVal = T{}, Node* nextPtr = nullptr) : value{nodeVal}, next{nextPtr} {
+            count_nodes.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~Node() {
+            [[maybe_unused]] const int n = count_nodes.fetch_sub(1, std::memory_order_relaxed);
+            assert(n > 0);  // number of existing nodes can never be negative
+        }
+
+        Node(const Node& rhs) = delete;
+        Node& operator=(const Node& rhs) = delete;
+
+        // Data members
+        T value;                  // value stored in the Node
+        std::atomic<Node*> next;  // Pointer to the next Node, possibly marked
+
+        inline static std::atomic<int> count_nodes = 0;  // total number of existing nodes
+    };
+
+    static_assert(alignof(Node) >= 2, "the lowest bit of a Node* is used as the erased mark");
+
+    Node* head;  // dummy Node, never erased
+    std::atomic<size_t> counter;
+    [[no_unique_address]] Compare comp;
+
+    static bool is_marked(Node* p) {
+        return (reinterpret_cast<std::uintptr_t>(p) & 1) != 0;
+    }
+
+    static Node* marked(Node* p) {
+        return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(p) | 1);
+    }
+
+    static Node* unmarked(Node* p) {
+        return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t{1});
+    }
+
+    static void delete_node(void* p) {
+        delete static_cast<Node*>(p);
+    }
+
+    /*
+     * Find the first Node curr with value not smaller than val, and its predecessor prev
+     * Marked Nodes on the way are unlinked and retired
+     * Return true if curr stores val
+     * Must be called in a critical section of the EpochDomain
+     */
+    bool find(const T& val, Node*& prev, Node*& curr);
+};
+
+/*
+ * A ConcurrentSet of ints
+ */
+using ConcurrentSet = BasicConcurrentSet<int>;
+
+/* *********************************************************** */
+/*            Member functions implementation                  */
+/* *********************************************************** */
+
+/*
+ *  Default constructor :create an empty Set
+ */
+template <class T, class Compare>
+BasicConcurrentSet<T, Compare>::BasicConcurrentSet() : head{new Node}, counter{0}, comp{} { // O(1)
+}
+
+/*
+ * Constructor to create a Set from a vector of values in any order
+ */
+template <class T, class Compare>
+BasicConcurrentSet<T, Compare>::BasicConcurrentSet(const std::vector<T>& list_of_values)
+    : BasicConcurrentSet() { // O(n log n)
+    // no other thread can see the Set yet: sort the values, as BasicSet::sort_batch,
+    // and link the Nodes from the largest value, so that the list is complete at each step
+    std::vector<T> values{list_of_values};
+    std::sort(values.begin(), values.end(), comp);
+    values.erase(std::unique(values.begin(), values.end(), [this](const T& a, const T& b) { return !comp(a, b); }),
+                 values.end());
+
+    for (auto it = values.rbegin(); it != values.rend(); ++it) {
+        head->next.store(new Node{*it, head->next.load(std::memory_order_relaxed)}, std::memory_order_relaxed);
+    }
+    counter.store(values.size(), std::memory_order_relaxed);
+}
+
+/*
+ * Destructor: deallocate all Nodes of the list
+ * Nodes already unlinked belong to the EpochDomain
+ */
+template <class T, class Compare>
+BasicConcurrentSet<T, Compare>::~BasicConcurrentSet() { // O(n)
+    Node* p = head;
+    while (p != nullptr) {
+        Node* next = unmarked(p->next.load(std::memory_order_relaxed));
+        delete p;
+        p = next;
+    }
+}
+
+/*
+ * Test whether val belongs to the Set -- wait-free
+ * Marked Nodes are walked through, not unlinked, so the traversal never restarts
+ */
+template <class T, class Compare>
+bool BasicConcurrentSet<T, Compare>::is_member(const T& val) const { // O(n)
+    EpochDomain::Guard guard;
+
+    Node* curr = unmarked(head->next.load(std::memory_order_acquire));
+    while (curr != nullptr && comp(curr->value, val)) {
+        curr = unmarked(curr->next.load(std::memory_order_acquire));
+    }
+    return curr != nullptr && !comp(val, curr->value) && !is_marked(curr->next.load(std::memory_order_acquire));
+}
+
+/*
+ * Add val to the Set -- lock-free
+ */
+template <class T, class Compare>
+bool BasicConcurrentSet<T, Compare>::insert(const T& val) { // O(n)
+    EpochDomain::Guard guard;
+
+    Node* newNode = nullptr;
+    Node* prev;
+    Node* curr;
+    while (true) {
+        if (find(val, prev, curr)) {
+            delete newNode;  // never visible to other threads
+            return false;
+        }
+        if (newNode == nullptr) {
+            newNode = new Node{val};
+        }
+        newNode->next.store(curr, std::memory_order_relaxed);
+
+        // fails if prev was marked or another Node was linked after prev
+        if (prev->next.compare_exchange_strong(curr, newNode, std::memory_order_release, std::memory_order_relaxed)) {
+            counter.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+/*
+ * Remove val from the Set -- lock-free
+ */
+template <class T, class Compare>
+bool BasicConcurrentSet<T, Compare>::erase(const T& val) { // O(n)
+    EpochDomain::Guard guard;
+
+    Node* prev;
+    Node* curr;
+    while (true) {
+        if (!find(val, prev, curr)) {
+            return false;
+        }
+
+        // logical removal: mark curr, so that nothing can be linked after it
+        Node* succ = curr->next.load(std::memory_order_acquire);
+        if (is_marked(succ)) {
+            continue;  // erased by another thread, find unlinks it
+        }
+        if (!curr->next.compare_exchange_strong(succ, marked(succ), std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+            continue;
+        }
+        counter.fetch_sub(1, std::memory_order_relaxed);
+
+        // physical removal, otherwise left to the next find passing by
+        if (prev->next.compare_exchange_strong(curr, succ, std::memory_order_release, std::memory_order_relaxed)) {
+            EpochDomain::instance().retire(curr, &delete_node);
+        } else {
+            find(val, prev, curr);
+        }
+        return true;
+    }
+}
+
+/*
+ * Return the values of the Set in increasing order
+ */
+template <class T, class Compare>
+std::vector<T> BasicConcurrentSet<T, Compare>::to_vector() const { // O(n)
+    EpochDomain::Guard guard;
+
+    std::vector<T> values;
+    values.reserve(cardinality());
+    for (Node* p = unmarked(head->next.load(std::memory_order_acquire)); p != nullptr;) {
+        Node* next = p->next.load(std::memory_order_acquire);
+        if (!is_marked(next)) {
+            values.push_back(p->value);
+        }
+        p = unmarked(next);
+    }
+    return values;
+}
+
+/*
+ * Find the first Node curr with value not smaller than val, and its predecessor prev
+ */
+template <class T, class Compare>
+bool BasicConcurrentSet<T, Compare>::find(const T& val, Node*& prev, Node*& curr) { // O(n)
+    bool restart = true;
+    while (restart) {
+        restart = false;
+        prev = head;
+        curr = prev->next.load(std::memory_order_acquire);  // the dummy Node is never marked
+
+        while (curr != nullptr) {
+            Node* succ = curr->next.load(std::memory_order_acquire);
+
+            if (is_marked(succ)) {
+                // curr is erased: unlink it, which fails if prev is erased too
+                Node* expected = curr;
+                if (!prev->next.compare_exchange_strong(expected, unmarked(succ), std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+                    restart = true;  // start again from head
+                    break;
+                }
+                EpochDomain::instance().retire(curr, &delete_node);
+                curr = unmarked(succ);
+                continue;
+            }
+
+            if (!comp(curr->value, val)) {
+                return !comp(val, curr->value);
+            }
+            prev = curr;
+            curr = succ;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,191 @@
+#include "epoch.h"
+
+#include <cassert>
+
+/*
+ * Releases the Record of a thread when the thread exits, so that another thread can reuse it
+ * Objects retired by the thread and not deleted yet stay in the Record
+ */
+struct EpochDomain::Owner {
+    Record* record;
+
+    ~Owner() {
+        EpochDomain::instance().release_record(record);
+    }
+};
+
+EpochDomain::Guard::Guard() {
+    EpochDomain::instance().enter();
+}
+
+EpochDomain::Guard::~Guard() {
+    EpochDomain::instance().exit();
+}
+
+/*
+ * Return the domain of the program
+ */
+EpochDomain& EpochDomain::instance() {
+    static EpochDomain domain;
+    return domain;
+}
+
+/*
+ * Destructor: delete all retired objects, no thread can be in a critical section anymore
+ */
+EpochDomain::~EpochDomain() {
+    Record* r = records.load(std::memory_order_acquire);
+    while (r != nullptr) {
+        for (const Retired& x : r->limbo) {
+            x.deleter(x.ptr);
+        }
+        Record* next = r->next;
+        delete r;
+        r = next;
+    }
+}
+
+/*
+ * Start a critical section of the calling thread -- O(1)
+ */
+void EpochDomain::enter() {
+    Record& r = local_record();
+    if (r.depth++ == 0) {
+        // announce the epoch before reading any shared node
+        const std::uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+        r.state.store((epoch << 1) | 1, std::memory_order_seq_cst);
+    }
+}
+
+/*
+ * End a critical section of the calling thread -- O(1)
+ */
+void EpochDomain::exit() {
+    Record& r = local_record();
+    assert(r.depth > 0);
+    if (--r.depth == 0) {
+        r.state.store(r.state.load(std::memory_order_relaxed) & ~std::uint64_t{1}, std::memory_order_release);
+    }
+}
+
+/*
+ * Delete p with deleter when no critical section can refer to it anymore
+ */
+void EpochDomain::retire(void* p, void (*deleter)(void*)) {
+    Record& r = local_record();
+    assert(r.depth > 0);
+
+    // p is already unlinked: a critical section started after this epoch cannot reach it
+    r.limbo.push_back(Retired{p, deleter, global_epoch.load(std::memory_order_seq_cst)});
+    r.n_retired.store(r.limbo.size(), std::memory_order_relaxed);
+
+    if (++r.since_collect >= collect_threshold) {
+        try_advance();
+        collect(r);
+    }
+}
+
+/*
+ * Delete the retired objects of all threads that are safe to delete
+ */
+void EpochDomain::reclaim() {
+    Record& mine = local_record();
+
+    // two advances make everything retired so far safe, if no other thread lags behind
+    try_advance();
+    try_advance();
+
+    for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        if (r == &mine) {
+            collect(mine);
+            continue;
+        }
+        // the Record of an exited thread: borrow it
+        bool expected = false;
+        if (r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            collect(*r);
+            r->in_use.store(false, std::memory_order_release);
+        }
+    }
+}
+
+/*
+ * Number of retired objects not deleted yet, of all threads
+ */
+size_t EpochDomain::count_retired() const {
+    size_t n = 0;
+    for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        n += r->n_retired.load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+/*
+ * Return the Record of the calling thread, acquired on the first call
+ */
+EpochDomain::Record& EpochDomain::local_record() {
+    thread_local Owner owner{acquire_record()};
+    return *owner.record;
+}
+
+/*
+ * Reuse a released Record or add a new Record to the domain -- lock-free
+ */
+EpochDomain::Record* EpochDomain::acquire_record() {
+    for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        bool expected = false;
+        if (!r->in_use.load(std::memory_order_relaxed) &&
+            r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return r;
+        }
+    }
+
+    auto r = new Record;
+    r->in_use.store(true, std::memory_order_relaxed);
+    r->next = records.load(std::memory_order_relaxed);
+    while (!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return r;
+}
+
+void EpochDomain::release_record(Record* r) {
+    assert(r->depth == 0);
+    try_advance();
+    collect(*r);
+    r->since_collect = 0;
+    r->in_use.store(false, std::memory_order_release);
+}
+
+/*
+ * Advance the global epoch, if every thread in a critical section has observed it
+ * Return true if the epoch was advanced
+ */
+bool EpochDomain::try_advance() {
+    std::uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        const std::uint64_t s = r->state.load(std::memory_order_seq_cst);
+        if ((s & 1) != 0 && (s >> 1) != epoch) {
+            return false;
+        }
+    }
+    return global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+}
+
+/*
+ * Delete the objects retired in r at least two epochs ago -- O(r.limbo.size())
+ */
+void EpochDomain::collect(Record& r) {
+    const std::uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+
+    size_t kept = 0;
+    for (const Retired& x : r.limbo) {
+        if (x.epoch + 2 <= epoch) {
+            x.deleter(x.ptr);
+        } else {
+            r.limbo[kept++] = x;
+        }
+    }
+    r.limbo.resize(kept);
+    r.n_retired.store(kept, std::memory_order_relaxed);
+    r.since_collect = 0;
+}
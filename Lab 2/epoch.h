@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/** Class EpochDomain
+ *
+ * Epoch-based memory reclamation for lock-free data structures, e.g. ConcurrentSet
+ *
+ * A thread reads shared nodes only inside a critical section, i.e. while an EpochDomain::Guard
+ * exists. A node unlinked from the structure is retired instead of deleted: it is tagged with
+ * the global epoch and deleted once the global epoch has advanced twice, since then every
+ * critical section that could still refer to it has ended
+ * The global epoch advances when all threads in a critical section have observed it
+ *
+ * There is one domain for the whole program, shared by all lock-free structures
+ * Each thread gets a Record, its slot in the domain, on the first critical section
+ * A thread that stays in a critical section forever prevents any reclamation
+ */
+class EpochDomain {
+public:
+    /*
+     * Guard: a critical section of the calling thread, while the Guard exists
+     * Guards may be nested
+     */
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /*
+     * Return the domain of the program
+     */
+    static EpochDomain& instance();
+
+    /*
+     * Delete p with deleter when no critical section can refer to it anymore
+     * p must be unlinked and the calling thread must be in a critical section
+     */
+    void retire(void* p, void (*deleter)(void*));
+
+    /*
+     * Delete the retired objects of all threads that are safe to delete
+     * Outside of a critical section, with no other thread in one, everything retired is deleted
+     */
+    void reclaim();
+
+    /*
+     * Number of retired objects not deleted yet, of all threads
+     */
+    size_t count_retired() const;
+
+    ~EpochDomain();
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+private:
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+        std::uint64_t epoch;  // global epoch when ptr was retired
+    };
+
+    // one cache line per thread, to avoid false sharing of state
+    struct alignas(64) Record {
+        std::atomic<std::uint64_t> state{0};  // (epoch << 1) | 1 while in a critical section
+        std::atomic<bool> in_use{false};      // owned by a thread
+        Record* next = nullptr;               // next Record of the domain, never changes once linked
+
+        // only accessed by the owning thread
+        int depth = 0;                        // number of nested Guards
+        std::vector<Retired> limbo;           // retired objects not deleted yet
+        size_t since_collect = 0;             // retirements since the last reclamation
+        std::atomic<size_t> n_retired{0};     // limbo.size(), readable by other threads
+    };
+
+    static constexpr size_t collect_threshold = 64;  // retirements between two reclamations
+
+    std::atomic<std::uint64_t> global_epoch{0};
+    std::atomic<Record*> records{nullptr};  // Records are never removed, only released for reuse
+
+    EpochDomain() = default;
+
+    void enter();
+    void exit();
+
+    Record& local_record();
+    Record* acquire_record();
+    void release_record(Record* r);
+
+    bool try_advance();
+    void collect(Record& r);
+
+    struct Owner;  // releases the Record of a thread when the thread exits
+};
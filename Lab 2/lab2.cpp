@@ -2,8 +2,57 @@
 #include <iomanip>
 #include <sstream>
 #include <cassert>
+#include <algorithm>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <cmath>
 
 #include "set.h"
+#include "unrolledset.h"
+#include "concurrentset.h"
+#include "setindex.h"
+
+/*
+ * Value without a std::hash specialization: BasicSet hashes its bytes
+ */
+struct Point {
+    int x;
+    int y;
+
+    auto operator<=>(const Point&) const = default;
+};
+
+/*
+ * Ordering by absolute value: equivalent values, e.g. -3 and 3, are not equal
+ */
+struct AbsLess {
+    bool operator()(int a, int b) const {
+        return std::abs(a) < std::abs(b);
+    }
+};
+
+/*
+ * True if a Set of type S can have a Bloom filter
+ */
+template <class S>
+constexpr bool has_bloom_filter_v = requires(S s) { s.enable_bloom_filter(); };
+
+/*
+ * True if a Set of type S has a hash
+ */
+template <class S>
+constexpr bool has_hash_v = requires(const S& s) { s.hash(); };
+
+/*
+ * True if a Set of type S has a MinHash sketch and can be stored in a BasicSetIndex
+ */
+template <class S>
+constexpr bool has_sketch_v = requires(S s) {
+    s.enable_sketch();
+    s.sketch();
+    typename BasicSetIndex<typename S::value_type, typename S::value_compare>;
+};
 
 int main() {
     /*****************************************************
@@ -311,5 +360,552 @@ int main() {
     }
     assert(Set::get_count_nodes() == 0);
 
+    /*****************************************************
+     * TEST PHASE 10                                      *
+     * Values without std::hash                           *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 10: values without std::hash\n";
+
+    {
+        using PointSet = BasicSet<Point>;
+
+        std::vector<Point> A1{{1, 2}, {0, 5}, {1, 1}, {3, 0}};
+        std::vector<Point> A2{{3, 0}, {1, 1}, {0, 5}, {1, 2}};
+
+        PointSet S1{A1, PointSet::unsorted};
+        PointSet S2{A2, PointSet::unsorted};
+        assert(PointSet::get_count_nodes() == 12);
+
+        // test
+        assert(S1 == S2);
+        assert(S1.hash() == S2.hash());
+        assert((*S1.begin() == Point{0, 5}));
+
+        S1.enable_bloom_filter();
+        std::vector<Point> A3{{1, 1}};
+        S1.erase_batch(A3);
+        assert(PointSet::get_count_nodes() == 11);
+
+        // test
+        assert(S1 != S2);
+        assert(!S1.is_member(Point{1, 1}));
+        assert(S1.is_member(Point{1, 2}) && S1.is_member(Point{3, 0}));
+        assert(((S2 - S1) == PointSet{Point{1, 1}}));
+    }
+    assert(BasicSet<Point>::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 11                                      *
+     * Batch insertion and removal                        *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 11: insert_batch and erase_batch\n";
+
+    {
+        std::vector<int> A1{9, 2, 7, 2, 5, -3, 9, 0};
+        std::vector<int> A2{8, -3, 100, 8, 1};
+        std::vector<int> A3{9, 1, 42, -3, 2};
+
+        Set S1{A1, Set::unsorted};
+        assert(Set::get_count_nodes() == 8);
+
+        // same Set, one value at a time
+        Set S2{};
+        for (int val : A1) {
+            S2 += val;
+        }
+        assert(Set::get_count_nodes() == 16);
+
+        // test
+        assert(S1 == S2);
+        assert(S1 == Set(std::vector<int>{-3, 0, 2, 5, 7, 9}));
+
+        S1.insert_batch(A2).erase_batch(A3);
+        for (int val : A2) {
+            S2 += val;
+        }
+        for (int val : A3) {
+            S2 -= val;
+        }
+        assert(Set::get_count_nodes() == 14);
+
+        // test
+        assert(S1 == S2);
+        assert(S1 == Set(std::vector<int>{0, 5, 7, 8, 100}));
+
+        S1.insert_batch({}).erase_batch({});
+        assert(S1 == S2);
+    }
+    assert(Set::get_count_nodes() == 0);
+
+    {
+        // large enough to be sorted in parallel, with repetitions
+        std::vector<int> A1(1 << 17);
+        for (size_t i = 0; i < A1.size(); ++i) {
+            A1[i] = static_cast<int>((i * 7919) % 100003) - 50000;
+        }
+        std::vector<int> A2{A1};
+        std::sort(A2.begin(), A2.end());
+        A2.erase(std::unique(A2.begin(), A2.end()), A2.end());
+
+        Set S1{A1, Set::unsorted};
+        Set S2{};
+        S2.insert_batch(A1);
+
+        // test
+        assert(S1.cardinality() == 100003);
+        assert(S1 == Set{A2});
+        assert(S2 == S1);
+
+        S2.erase_batch(A1);
+        assert(S2.is_empty());
+        assert(Set::get_count_nodes() == 100003 + 2 + 2);
+    }
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 12                                      *
+     * Binary format and SetView                          *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 12: binary format and SetView\n";
+
+    {
+        // several blocks of the binary format
+        std::vector<int> A1;
+        std::vector<int> A2;
+        for (int val = -300; val <= 300; ++val) {
+            if (val % 3 == 0) {
+                A1.push_back(val);
+            }
+            if (val % 5 == 0) {
+                A2.push_back(val);
+            }
+        }
+
+        Set S1{A1};
+        Set S2{A2};
+
+        std::ostringstream os{std::ios::binary};
+        S1.write_binary(os);
+        const std::string bytes{os.str()};
+
+        std::istringstream is{bytes, std::ios::binary};
+        Set S3 = Set::read_binary(is);
+
+        // test
+        assert(!is.fail());
+        assert(S3 == S1);
+
+        std::istringstream is_truncated{bytes.substr(0, bytes.size() / 2), std::ios::binary};
+        Set::read_binary(is_truncated);
+        assert(is_truncated.fail());
+
+        std::string corrupt{bytes};
+        corrupt[0] = 'X';  // magic
+        std::istringstream is_corrupt{corrupt, std::ios::binary};
+        Set::read_binary(is_corrupt);
+        assert(is_corrupt.fail());
+
+        std::ostringstream os_empty{std::ios::binary};
+        Set{}.write_binary(os_empty);
+        std::istringstream is_empty{os_empty.str(), std::ios::binary};
+        assert(Set::read_binary(is_empty).is_empty() && !is_empty.fail());
+
+        SetView V{std::as_bytes(std::span{bytes})};
+
+        // test
+        assert(V.is_valid());
+        assert(V.cardinality() == S1.cardinality());
+        assert(Set{V} == S1);
+        assert(V.is_member(-300) && V.is_member(0) && V.is_member(300) && !V.is_member(301));
+
+        assert(!SetView{std::as_bytes(std::span{bytes}).first(bytes.size() / 2)}.is_valid());
+        assert(!SetView{std::as_bytes(std::span{corrupt})}.is_valid());
+
+        // test
+        assert((Set{S2} += V) == S2 + S1);
+        assert((Set{S2} *= V) == S2 * S1);
+        assert((Set{S2} -= V) == S2 - S1);
+        assert((Set{} *= V).is_empty());
+        assert((Set{} += V) == S1);
+
+        std::ostringstream os2{std::ios::binary};
+        S2.write_binary(os2);
+        const std::string bytes2{os2.str()};
+        SetView V2{std::as_bytes(std::span{bytes2})};
+
+        std::ostringstream os3{std::ios::binary};
+        {
+            SetEncoder encoder{os3};
+            set_difference(V, V2, encoder);
+        }
+        const std::string bytes3{os3.str()};
+
+        // test
+        assert(Set{SetView{std::as_bytes(std::span{bytes3})}} == S1 - S2);
+    }
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 13                                      *
+     * Order statistics: rank, select, count_range, range *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 13: rank, select, count_range, and range\n";
+
+    {
+        Set S1{};
+
+        // test
+        assert(S1.rank(0) == 0);
+        assert(S1.count_range(-10, 10) == 0);
+        assert(S1.range(-10, 10).empty());
+
+        Set S2{std::vector<int>{10, 20, 30, 40, 50}};
+
+        // test
+        assert(S2.rank(5) == 0);
+        assert(S2.rank(10) == 0);
+        assert(S2.rank(11) == 1);
+        assert(S2.rank(50) == 4);
+        assert(S2.rank(51) == 5);
+
+        assert(S2.select(0) == 10);
+        assert(S2.select(2) == 30);
+        assert(S2.select(4) == 50);
+
+        assert(S2.count_range(10, 50) == 5);
+        assert(S2.count_range(11, 49) == 3);
+        assert(S2.count_range(50, 50) == 1);
+        assert(S2.count_range(0, 9) == 0);
+        assert(S2.count_range(51, 100) == 0);
+        assert(S2.count_range(50, 10) == 0);
+
+        auto r = S2.range(20, 40);
+        assert((std::vector<int>(r.begin(), r.end()) == std::vector<int>{20, 30, 40}));
+        assert(S2.range(0, 10).begin() == S2.begin());
+        assert(S2.range(50, 99).end() == S2.end());
+        assert(S2.range(51, 60).empty());
+        assert(S2.range(60, 0).empty());
+
+        // the index follows the modifications of the Set
+        S2 += 25;
+        S2 -= 10;
+
+        // test
+        assert(S2.rank(30) == 2);
+        assert(S2.select(0) == 20);
+        assert(S2.select(1) == 25);
+        assert(S2.count_range(20, 30) == 3);
+
+        // queries between single insertions and removals, the index is updated instead of rebuilt
+        Set S3{};
+        for (int val = 0; val < 200; ++val) {
+            S3 += 2 * val;
+            assert(S3.rank(2 * val) == static_cast<size_t>(val));
+            assert(S3.select(static_cast<size_t>(val) / 2) == val / 2 * 2);
+        }
+        for (int val = 0; val < 200; val += 2) {
+            S3 -= 2 * val;
+            assert(S3.rank(2 * val + 1) == static_cast<size_t>(val / 2));
+            assert(S3.count_range(0, 2 * val) == static_cast<size_t>(val / 2));
+        }
+    }
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 14                                      *
+     * Bloom filter in front of is_member                 *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 14: Bloom filter\n";
+
+    {
+        std::vector<int> A1;
+        std::vector<int> A2;
+        for (int val = 0; val < 2000; val += 2) {
+            A1.push_back(val);
+            if (val % 4 == 0) {
+                A2.push_back(val);
+            }
+        }
+
+        Set S1{};
+        S1.enable_bloom_filter(0.01);
+        S1.insert_batch(A1);
+
+        // test: no false negatives after insertions
+        for (int val : A1) {
+            assert(S1.is_member(val));
+        }
+        assert(S1.bloom_stats().hits == A1.size());
+
+        S1.erase_batch(A2);
+        S1 += 7;
+
+        // test: no false negatives after removals
+        for (int val = 0; val < 2000; ++val) {
+            assert(S1.is_member(val) == ((val % 4 == 2) || val == 7));
+        }
+
+        Set S2{S1};
+        assert(S2.has_bloom_filter());
+
+        S1.reset_bloom_stats();
+        for (int val = 1; val < 20000; val += 2) {
+            assert(S1.is_member(val) == (val == 7));
+        }
+
+        // test: absent values are rejected at about the rate of the filter
+        const BloomStats stats = S1.bloom_stats();
+        assert(stats.hits == 1);
+        assert(stats.misses + stats.false_positives == 9999);
+        assert(stats.false_positives < 9999 / 20);
+
+        S1.disable_bloom_filter();
+        assert(!S1.has_bloom_filter() && S1.is_member(7));
+
+        // no Bloom filter if equivalent values are not equal: it would reject them
+        using AbsSet = BasicSet<int, AbsLess>;
+        static_assert(has_bloom_filter_v<Set> && !has_bloom_filter_v<AbsSet>);
+
+        AbsSet S3{std::vector<int>{3, 5, 7}};
+        assert(S3.is_member(-3) && S3.is_member(5) && !S3.is_member(4));
+    }
+    assert((BasicSet<int, AbsLess>::get_count_nodes() == 0));
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 15                                      *
+     * UnrolledSet: same results as Set                   *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 15: UnrolledSet against Set\n";
+
+    {
+        auto same = [](const UnrolledSet& U, const Set& S) {
+            return U.cardinality() == S.cardinality() && std::equal(U.begin(), U.end(), S.begin());
+        };
+
+        // many Blocks, with repetitions
+        std::vector<int> A1;
+        std::vector<int> A2;
+        for (int i = 0; i < 600; ++i) {
+            A1.push_back((i * 37) % 1000);
+        }
+        for (int i = 0; i < 400; ++i) {
+            A2.push_back((i * 53) % 700 + 300);
+        }
+
+        UnrolledSet U1{A1, UnrolledSet::unsorted};
+        UnrolledSet U2{A2, UnrolledSet::unsorted};
+        Set S1{A1, Set::unsorted};
+        Set S2{A2, Set::unsorted};
+
+        // test
+        assert(same(U1, S1) && same(U2, S2));
+        assert(same(U1 + U2, S1 + S2));
+        assert(same(U1 * U2, S1 * S2));
+        assert(same(U1 - U2, S1 - S2));
+        assert(same(U2 - U1, S2 - S1));
+        assert((U1 <=> U2) == (S1 <=> S2));
+        assert(((U1 * U2) <=> U1) == std::partial_ordering::less);
+        assert((U1 + U2) == (U2 + U1));
+
+        // split full Blocks and merge Blocks that underflow
+        for (int val = 1000; val < 1100; ++val) {
+            assert(U1.insert(val));
+            S1 += val;
+        }
+        assert(!U1.insert(1000));
+        for (int val = 0; val < 1100; val += 3) {
+            U1.erase(val);
+            S1 -= val;
+        }
+        assert(!U1.erase(0));
+
+        // test
+        assert(same(U1, S1));
+        for (int val = 0; val < 1100; ++val) {
+            assert(U1.is_member(val) == S1.is_member(val));
+        }
+
+        U1 -= U1;
+        assert(U1.is_empty());
+    }
+    assert(UnrolledSet::get_count_blocks() == 0);
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 16                                      *
+     * Hash of a Set                                      *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 16: hash and equality\n";
+
+    {
+        std::vector<int> A1{4, -8, 15, 16, 23, 42};
+        std::vector<int> A2{42, 23, 16, 15, -8, 4};
+
+        Set S1{A1, Set::unsorted};
+
+        // same values, inserted in another order
+        Set S2{};
+        for (int val : A2) {
+            S2 += val;
+        }
+
+        // same values, after insertions and removals of other values
+        Set S3 = Set{std::vector<int>{-8, 0, 4, 99}} + Set{std::vector<int>{15, 16, 23, 42, 100}};
+        S3 -= Set{std::vector<int>{0, 99, 100}};
+
+        // test
+        assert(S1 == S2 && S2 == S3);
+        assert(S1.hash() == S2.hash() && S2.hash() == S3.hash());
+        assert(std::hash<Set>{}(S1) == std::hash<Set>{}(S3));
+
+        S3 -= 4;
+        S3 += 5;
+
+        // test: same cardinality, different values
+        assert(S1 != S3);
+        assert(S1.hash() != S3.hash());
+
+        S3 -= 5;
+        S3 += 4;
+        assert(S1 == S3 && S1.hash() == S3.hash());
+
+        assert(Set{}.hash() == (S1 - S2).hash());
+
+        std::unordered_set<Set> H{S1, S2, S3, Set{}, Set{4}};
+        assert(H.size() == 3);
+        assert(H.contains(Set{A2, Set::unsorted}));
+
+        // no hash if equivalent values are not equal: {3} == {-3} would have different hashes
+        using AbsSet = BasicSet<int, AbsLess>;
+        static_assert(std::is_default_constructible_v<std::hash<Set>>);
+        static_assert(!std::is_default_constructible_v<std::hash<AbsSet>>);
+        static_assert(has_hash_v<Set> && !has_hash_v<AbsSet>);
+
+        assert(AbsSet{3} == AbsSet{-3});
+    }
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 17                                      *
+     * ConcurrentSet shared by several threads            *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 17: ConcurrentSet\n";
+
+    {
+        ConcurrentSet CS0{std::vector<int>{9, 2, 7, 2, 5, -3, 9, 0}};
+        assert(CS0.cardinality() == 6 && ConcurrentSet::get_count_nodes() == 7);
+        assert((CS0.to_vector() == std::vector<int>{-3, 0, 2, 5, 7, 9}));
+        assert(CS0.insert(1) && !CS0.insert(9) && CS0.erase(-3) && CS0.is_member(1));
+        assert((CS0.to_vector() == std::vector<int>{0, 1, 2, 5, 7, 9}));
+
+        constexpr int n_threads = 4;
+        constexpr int n_values = 2000;
+
+        ConcurrentSet CS{};
+        std::atomic<int> n_inserted{0};
+        std::atomic<int> n_erased{0};
+
+        // every thread tries to insert every value: each value is inserted exactly once
+        {
+            std::vector<std::jthread> threads;
+            for (int t = 0; t < n_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    for (int i = 0; i < n_values; ++i) {
+                        const int val = (i * 7 + t * 500) % n_values;
+                        if (CS.insert(val)) {
+                            ++n_inserted;
+                        }
+                    }
+                });
+            }
+        }
+
+        // test
+        assert(n_inserted == n_values);
+        assert(CS.cardinality() == n_values);
+
+        // every thread tries to erase the even values, while the odd values are looked up
+        {
+            std::vector<std::jthread> threads;
+            for (int t = 0; t < n_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    for (int i = 0; i < n_values; ++i) {
+                        const int val = (i + t * 500) % n_values;
+                        if (val % 2 == 0) {
+                            if (CS.erase(val)) {
+                                ++n_erased;
+                            }
+                        } else {
+                            assert(CS.is_member(val));
+                        }
+                    }
+                });
+            }
+        }
+
+        // test
+        assert(n_erased == n_values / 2);
+        assert(CS.cardinality() == n_values / 2);
+
+        const std::vector<int> A1 = CS.to_vector();
+        assert(A1.size() == n_values / 2);
+        for (size_t i = 0; i < A1.size(); ++i) {
+            assert(A1[i] == static_cast<int>(2 * i + 1));
+        }
+    }
+    EpochDomain::instance().reclaim();
+    assert(ConcurrentSet::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 18                                      *
+     * MinHash sketches: estimated similarity             *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 18: MinHash similarity\n";
+
+    {
+        std::vector<int> A1;
+        std::vector<int> A2;
+        std::vector<int> A3;
+        for (int val = 0; val < 1000; ++val) {
+            A1.push_back(val);
+            A2.push_back(val + 500);
+            A3.push_back(val + 2000);
+        }
+
+        Set S1{A1};
+        Set S2{A2};
+        Set S3{A3};
+
+        // same values as S1, the sketch is maintained while the values are inserted
+        Set S4{};
+        S4.enable_sketch();
+        S4.insert_batch(A3).insert_batch(A1).erase_batch(A3);
+
+        // test: exact similarity
+        assert(S1.similarity(S4) == 1.0);
+        assert(S1.similarity(S2) == 1.0 / 3);
+        assert(S1.similarity(S3) == 0.0);
+        assert(Set{}.similarity(Set{}) == 1.0);
+
+        // test: estimated similarity of identical, overlapping, and disjoint Sets
+        assert(S1.sketch().signature() == S4.sketch().signature());
+        assert(S1.sketch().similarity(S4.sketch()) == 1.0);
+        assert(std::abs(S1.sketch().similarity(S2.sketch()) - 1.0 / 3) < 0.15);
+        assert(S1.sketch().similarity(S3.sketch()) < 0.05);
+
+        // S1 and S4 are near-duplicates, S2 and S3 are not
+        SetIndex index{};
+        index.insert(S2);
+        index.insert(S3);
+        index.insert(S4);
+        assert((index.near_duplicates(S1, 0.9) == std::vector<size_t>{2}));
+        assert(index.near_duplicates(Set{std::vector<int>{5000, 5001}}, 0.5).empty());
+
+        // no sketch if equivalent values are not equal: {-3, 5} and {3, 5} would not be similar
+        static_assert(has_sketch_v<Set> && !has_sketch_v<BasicSet<int, AbsLess>>);
+    }
+    assert(Set::get_count_nodes() == 0);
+
     std::cout << "Success!!\n";
 }
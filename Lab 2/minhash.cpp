@@ -0,0 +1,70 @@
+#include "minhash.h"
+#include "bloomfilter.h"
+
+/*
+ * Add key to the sketch -- O(1)
+ */
+void MinHash::insert(std::uint64_t key) {
+    const std::uint64_t h = mix64(key + 0xD1B54A32D192ED03ULL);
+    const auto bin = static_cast<std::size_t>(((h >> 32) * n_bins) >> 32);
+    const auto val = static_cast<std::uint32_t>(h) & ~std::uint32_t{1};  // never equal to empty_bin
+
+    if (bins[bin] == empty_bin) {
+        ++n_filled;
+    }
+    if (val < bins[bin]) {
+        bins[bin] = val;
+    }
+}
+
+/*
+ * Remove all keys from the sketch
+ */
+void MinHash::clear() {
+    bins.fill(empty_bin);
+    n_filled = 0;
+}
+
+/*
+ * Return the densified sketch
+ * An empty bin i copies the first non empty bin of a pseudo-random sequence depending only on i,
+ * so that the empty bins of two sketches agree as often as their non empty bins (optimal densification)
+ */
+MinHash::Signature MinHash::signature() const { // O(n_bins) expected
+    if (n_filled == 0 || n_filled == n_bins) {
+        return bins;
+    }
+
+    Signature sig = bins;
+    for (std::size_t i = 0; i < n_bins; ++i) {
+        if (bins[i] != empty_bin) {
+            continue;
+        }
+        for (std::uint64_t attempt = 1;; ++attempt) {
+            const std::uint64_t h = mix64((static_cast<std::uint64_t>(i) << 32) + attempt);
+            const auto j = static_cast<std::size_t>(((h >> 32) * n_bins) >> 32);
+            if (bins[j] != empty_bin) {
+                sig[i] = bins[j];
+                break;
+            }
+        }
+    }
+    return sig;
+}
+
+/*
+ * Return the estimated Jaccard similarity of the sets sketched by *this and M
+ */
+double MinHash::similarity(const MinHash& M) const { // O(n_bins)
+    if (is_empty() || M.is_empty()) {
+        return (is_empty() && M.is_empty()) ? 1.0 : 0.0;
+    }
+
+    const Signature s1 = signature();
+    const Signature s2 = M.signature();
+    std::size_t n_equal = 0;
+    for (std::size_t i = 0; i < n_bins; ++i) {
+        n_equal += (s1[i] == s2[i]);
+    }
+    return static_cast<double>(n_equal) / static_cast<double>(n_bins);
+}
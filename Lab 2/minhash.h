@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/** Class MinHash
+ *
+ * A one-permutation MinHash sketch of a set of 64-bit keys, to estimate the Jaccard similarity
+ * |A*B| / |A+B| of two sets without comparing their values
+ *
+ * Each key is hashed once: the high bits of the hash choose one of n_bins bins, and the bin keeps
+ * the smallest low bits of the hashes that fell in it. Adding a key is O(1), but keys cannot be
+ * removed: the sketch must be rebuilt instead
+ * Empty bins are filled from other bins (densification) when the signature is computed, so that
+ * sketches of small sets can still be compared
+ *
+ * The standard error of the estimated similarity J is about sqrt(J * (1 - J) / n_bins)
+ */
+class MinHash {
+public:
+    static constexpr std::size_t n_bins = 128;
+
+    using Signature = std::array<std::uint32_t, n_bins>;
+
+    /*
+     * Constructor: sketch of the empty set
+     */
+    MinHash() {
+        clear();
+    }
+
+    /*
+     * Add key to the sketch -- O(1)
+     */
+    void insert(std::uint64_t key);
+
+    /*
+     * Remove all keys from the sketch
+     */
+    void clear();
+
+    bool is_empty() const {
+        return n_filled == 0;
+    }
+
+    /*
+     * Return the densified sketch: no empty bins, unless the set is empty -- O(n_bins)
+     * Two sets have the same value in a bin with probability equal to their Jaccard similarity
+     */
+    Signature signature() const;
+
+    /*
+     * Return the estimated Jaccard similarity of the sets sketched by *this and M -- O(n_bins)
+     */
+    double similarity(const MinHash& M) const;
+
+private:
+    static constexpr std::uint32_t empty_bin = 0xFFFFFFFF;
+
+    Signature bins;        // smallest hash of each bin, empty_bin if no key fell in the bin
+    std::size_t n_filled;  // number of bins that are not empty
+};
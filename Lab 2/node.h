@@ -1,23 +1,25 @@
 #pragma once
 
 #include <cassert>
+#include <atomic>
 
 /** Class Set::Node
  *
- * This class represents an internal node of a doubly linked list storing an int
+ * This class represents an internal node of a doubly linked list storing a value of type T
  * All members of class Set::Node are public
  * but only class Set can access them, since Node is declared in the private part of class Set
  *
  */
-class Set::Node {
+template <class T, class Compare, class Allocator>
+class BasicSet<T, Compare, Allocator>::Node {
 public:
     /*
      * Constructor
-     * \param nodeVal int to be stored in the Node
+     * \param nodeVal value to be stored in the Node
      * \param nextPtr a pointer to the next Node in the list
      * \param prevPtr a pointer to the previous Node in the list
      */
-    explicit Node(int nodeVal = 0, Node* nextPtr = nullptr, Node* prevPtr = nullptr)
+    explicit Node(const T& nodeVal = T{}, Node* nextPtr = nullptr, Node* prevPtr = nullptr)
         : value{nodeVal}, next{nextPtr}, prev{prevPtr} {
         ++count_nodes;
     }
@@ -41,9 +43,11 @@ public:
     Node& operator=(const Node& rhs) = delete;
 
     // Data members
-    int value;   // int stored in the Node
+    T value;     // value stored in the Node
     Node* next;  // Pointer to the next Node
     Node* prev;  // Pointer to the previous Node
 
-    static int count_nodes;  // total number of existing nodes -- to help to detect bugs in the code
+    // total number of existing nodes -- to help to detect bugs in the code
+    // atomic, since Sets may be used by different threads
+    inline static std::atomic<int> count_nodes = 0;
 };
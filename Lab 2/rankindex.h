@@ -0,0 +1,276 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+/** Class RankIndex
+ *
+ * Order-statistic index of the Nodes of a sorted list: a treap (randomized binary search tree)
+ * ordered by the values of the Nodes, where each entry stores the size of its subtree
+ *   insert, erase:                 O(log n) expected
+ *   lower_bound, upper_bound:      rank of a value, O(log n) expected
+ *   select:                        Node of a rank, O(log n) expected
+ *   build:                         from the Nodes in increasing order, O(n)
+ *
+ * The entries are kept in a vector and refer to each other by index, index 0 is the empty tree
+ * Node is any type with a member value of type T, ordered by Compare, and no two values are equivalent
+ */
+template <class T, class Node, class Compare>
+class RankIndex {
+public:
+    RankIndex() : entries(1), root{0}, free_list{0}, seed{0x9E3779B97F4A7C15ULL} {}
+
+    size_t size() const {
+        return entries[root].size;
+    }
+
+    /*
+     * Remove all Nodes from the index
+     */
+    void clear();
+
+    /*
+     * Replace the contents of the index by the n Nodes from first on, in increasing order
+     */
+    void build(Node* first, size_t n);
+
+    /*
+     * Add Node p, whose value is not yet in the index
+     */
+    void insert(Node* p, const Compare& comp);
+
+    /*
+     * Remove the Node storing a value equivalent to val, which is in the index
+     */
+    void erase(const T& val, const Compare& comp);
+
+    /*
+     * Return the number of Nodes whose value is smaller than val
+     */
+    size_t lower_bound(const T& val, const Compare& comp) const;
+
+    /*
+     * Return the number of Nodes whose value is not larger than val
+     */
+    size_t upper_bound(const T& val, const Compare& comp) const;
+
+    /*
+     * Return the Node of rank k, i.e. the k-th smallest value counting from k = 0
+     * \param k must be smaller than size()
+     */
+    Node* select(size_t k) const;
+
+private:
+    struct Entry {
+        Node* node = nullptr;
+        size_t left = 0;
+        size_t right = 0;
+        size_t size = 0;  // number of entries in the subtree, 0 for the empty tree
+        std::uint64_t priority = 0;  // a parent has a priority not smaller than its children
+    };
+
+    std::vector<Entry> entries;
+    size_t root;
+    size_t free_list;    // unused entries, linked by left
+    std::uint64_t seed;  // state of the generator of priorities
+
+    size_t new_entry(Node* p);
+
+    void update(size_t t) {
+        entries[t].size = entries[entries[t].left].size + 1 + entries[entries[t].right].size;
+    }
+
+    /*
+     * Split tree t into the entries whose value is smaller than val, l, and the others, r
+     */
+    void split(size_t t, const T& val, const Compare& comp, size_t& l, size_t& r);
+
+    /*
+     * Return the tree with the entries of l followed by the entries of r
+     */
+    size_t merge(size_t l, size_t r);
+
+    /*
+     * Compute the sizes of the subtrees of t, after build
+     */
+    void compute_sizes(size_t t);
+};
+
+/* ******************************************** *
+ * Member Functions -- Implementation           *
+ * ******************************************** */
+
+template <class T, class Node, class Compare>
+void RankIndex<T, Node, Compare>::clear() { // O(1)
+    entries.resize(1);
+    root = 0;
+    free_list = 0;
+}
+
+/*
+ * The entries get random priorities in list order, and the treap is their Cartesian tree,
+ * built with a stack of the rightmost path
+ */
+template <class T, class Node, class Compare>
+void RankIndex<T, Node, Compare>::build(Node* first, size_t n) { // O(n)
+    clear();
+    entries.reserve(n + 1);
+
+    std::vector<size_t> right_path;
+    Node* p = first;
+    for (size_t i = 0; i < n; ++i, p = p->next) {
+        const size_t t = new_entry(p);
+        size_t last = 0;
+        while (!right_path.empty() && entries[right_path.back()].priority < entries[t].priority) {
+            last = right_path.back();
+            right_path.pop_back();
+        }
+        entries[t].left = last;
+        if (!right_path.empty()) {
+            entries[right_path.back()].right = t;
+        }
+        right_path.push_back(t);
+    }
+
+    root = right_path.empty() ? 0 : right_path.front();
+    compute_sizes(root);
+    assert(size() == n);
+}
+
+template <class T, class Node, class Compare>
+void RankIndex<T, Node, Compare>::insert(Node* p, const Compare& comp) { // O(log n) expected
+    size_t l;
+    size_t r;
+    split(root, p->value, comp, l, r);
+    root = merge(merge(l, new_entry(p)), r);
+}
+
+template <class T, class Node, class Compare>
+void RankIndex<T, Node, Compare>::erase(const T& val, const Compare& comp) { // O(log n) expected
+    // the entry of val is the smallest one not smaller than val, found by descending to the left
+    size_t* link = &root;
+    while (true) {
+        const size_t t = *link;
+        assert(t != 0);
+        --entries[t].size;
+        if (comp(entries[t].node->value, val)) {
+            link = &entries[t].right;
+        } else if (comp(val, entries[t].node->value)) {
+            link = &entries[t].left;
+        } else {
+            *link = merge(entries[t].left, entries[t].right);
+            entries[t] = Entry{};
+            entries[t].left = free_list;
+            free_list = t;
+            return;
+        }
+    }
+}
+
+template <class T, class Node, class Compare>
+size_t RankIndex<T, Node, Compare>::lower_bound(const T& val, const Compare& comp) const { // O(log n) expected
+    size_t rank = 0;
+    for (size_t t = root; t != 0;) {
+        if (comp(entries[t].node->value, val)) {
+            rank += entries[entries[t].left].size + 1;
+            t = entries[t].right;
+        } else {
+            t = entries[t].left;
+        }
+    }
+    return rank;
+}
+
+template <class T, class Node, class Compare>
+size_t RankIndex<T, Node, Compare>::upper_bound(const T& val, const Compare& comp) const { // O(log n) expected
+    size_t rank = 0;
+    for (size_t t = root; t != 0;) {
+        if (!comp(val, entries[t].node->value)) {
+            rank += entries[entries[t].left].size + 1;
+            t = entries[t].right;
+        } else {
+            t = entries[t].left;
+        }
+    }
+    return rank;
+}
+
+template <class T, class Node, class Compare>
+Node* RankIndex<T, Node, Compare>::select(size_t k) const { // O(log n) expected
+    assert(k < size());
+    size_t t = root;
+    while (true) {
+        const size_t n_left = entries[entries[t].left].size;
+        if (k < n_left) {
+            t = entries[t].left;
+        } else if (k == n_left) {
+            return entries[t].node;
+        } else {
+            k -= n_left + 1;
+            t = entries[t].right;
+        }
+    }
+}
+
+/*
+ * Return an entry for Node p with a random priority, reusing an unused entry when possible
+ */
+template <class T, class Node, class Compare>
+size_t RankIndex<T, Node, Compare>::new_entry(Node* p) { // O(1) amortized
+    size_t t = free_list;
+    if (t != 0) {
+        free_list = entries[t].left;
+    } else {
+        t = entries.size();
+        entries.emplace_back();
+    }
+
+    // xorshift64*
+    seed ^= seed >> 12;
+    seed ^= seed << 25;
+    seed ^= seed >> 27;
+    entries[t] = Entry{p, 0, 0, 1, seed * 0x2545F4914F6CDD1DULL};
+    return t;
+}
+
+template <class T, class Node, class Compare>
+void RankIndex<T, Node, Compare>::split(size_t t, const T& val, const Compare& comp,
+                                     size_t& l, size_t& r) { // O(log n) expected
+    if (t == 0) {
+        l = r = 0;
+    } else if (comp(entries[t].node->value, val)) {
+        split(entries[t].right, val, comp, entries[t].right, r);
+        l = t;
+        update(t);
+    } else {
+        split(entries[t].left, val, comp, l, entries[t].left);
+        r = t;
+        update(t);
+    }
+}
+
+template <class T, class Node, class Compare>
+size_t RankIndex<T, Node, Compare>::merge(size_t l, size_t r) { // O(log n) expected
+    if (l == 0 || r == 0) {
+        return l + r;
+    }
+    if (entries[l].priority >= entries[r].priority) {
+        entries[l].right = merge(entries[l].right, r);
+        update(l);
+        return l;
+    }
+    entries[r].left = merge(l, entries[r].left);
+    update(r);
+    return r;
+}
+
+template <class T, class Node, class Compare>
+void RankIndex<T, Node, Compare>::compute_sizes(size_t t) { // O(n)
+    if (t != 0) {
+        compute_sizes(entries[t].left);
+        compute_sizes(entries[t].right);
+        update(t);
+    }
+}
@@ -2,41 +2,144 @@
 
 #include <iostream>
 #include <vector>
+#include <span>
+#include <ranges>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <functional>
+#include <type_traits>
+#include <algorithm>
+#include <execution>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
 #include <compare>  // three-way comparison operator <=>
+#include <bit>
 
-/** Class to represent a Set of ints
+#include "bloomfilter.h"
+#include "minhash.h"
+#include "rankindex.h"
+#include "setview.h"
+
+/*
+ * True if values of type T ordered by Compare can use the branch-light merge loops
+ * for arithmetic types, i.e. Compare is the built-in operator<
+ */
+template <class T, class Compare>
+constexpr bool is_natural_order_v =
+    std::is_arithmetic_v<T> && (std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>>);
+
+/*
+ * True if values of type T that are equivalent by Compare are equal, so that they have equal hashes,
+ * i.e. Compare is operator< or operator>
+ * Not true for other orderings, e.g. by absolute value: -3 and 3 are equivalent but not equal
+ */
+template <class T, class Compare>
+constexpr bool is_equality_order_v =
+    std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>> ||
+    std::is_same_v<Compare, std::greater<T>> || std::is_same_v<Compare, std::greater<>>;
+
+/** Class to represent a Set of values of type T
  *
- * Set is implemented as a sorted doubly linked list
+ * BasicSet is implemented as a sorted doubly linked list
  * Sets should not contain repetitions, i.e.
- * two ints with the same value cannot belong to a Set
+ * two equivalent values (neither is ordered before the other by Compare) cannot belong to a Set
+ *
+ * T must be default constructible (the dummy Nodes store T{}) and copy constructible
+ * T must have a std::hash specialization or, like a struct of integers, a unique object representation
+ * Compare is a strict weak ordering of T, Allocator is used to allocate the Nodes
  *
  * All Set operations must have a linear time complexity, in the worst case
  */
-class Set {
+template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+class BasicSet {
+    class Node;  // nested class defined in node.h
 
 public:
+    using value_type = T;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+
+    /*
+     * Bidirectional iterator to visit the values of a Set in increasing order
+     * Iterators stay valid until the Node they refer to is removed
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : ptr{nullptr} {}
+
+        reference operator*() const;
+
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        const_iterator& operator--();
+        const_iterator operator--(int);
+
+        bool operator==(const const_iterator& it) const = default;
+
+    private:
+        friend class BasicSet;
+
+        explicit const_iterator(const Node* p) : ptr{p} {}
+
+        const Node* ptr;
+    };
+
+    /*
+     * Tag type to select the constructor that accepts unsorted input
+     * Usage: Set S{V, Set::unsorted};
+     */
+    struct unsorted_t {
+        explicit unsorted_t() = default;
+    };
+    static constexpr unsorted_t unsorted{};
+
     /*
      *  Default constructor :create an empty Set
      */
-    Set();
+    BasicSet();
+
+    /*
+     *  Constructor: create an empty Set whose Nodes are allocated with alloc
+     */
+    explicit BasicSet(const Allocator& alloc);
 
     /*
      *  Conversion constructor: convert val into a singleton {val}
      */
-    Set(int val);
+    BasicSet(const T& val);
+
+    /*
+     * Constructor to create a Set from a sorted vector of unique values
+     * \param list_of_values is an increasingly sorted vector of unique values
+     */
+    explicit BasicSet(const std::vector<T>& list_of_values);
+
+    /*
+     * Constructor to create a Set from a vector of values in any order
+     * \param list_of_values vector of values, possibly unsorted and with repetitions
+     */
+    BasicSet(const std::vector<T>& list_of_values, unsorted_t);
 
     /*
-     * Constructor to create a Set from a sorted vector of unique ints
-     * \param list_of_values is an increasingly sorted vector of unique ints
+     * Constructor to create a Set with the values of a SetView
      */
-    explicit Set(const std::vector<int>& list_of_values);
+    explicit BasicSet(const SetView& V)
+        requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>);
 
     /*
      * Copy constructor: create a new Set as a copy of Set S
      * \param S Set to be copied
      * Function does not modify Set S in any way
      */
-    Set(const Set& S);
+    BasicSet(const BasicSet& S);
 
     /*
      * Transform the Set into an empty set
@@ -47,21 +150,93 @@ public:
     /*
      * Destructor: deallocate all memory (Nodes) allocated for the list
      */
-    ~Set();
+    ~BasicSet();
 
     /*
      * Assignment operator: assign new contents to the *this Set, replacing its current content
      * \param S Set to be copied into Set *this
      * Use copy-and swap idiom -- TNG033: lecture 5
+     * If the allocators are not equal and do not propagate, the values are copied instead
+     */
+    BasicSet& operator=(BasicSet S);
+
+    /*
+     * Return a copy of the allocator of the Set
      */
-    Set& operator=(Set S);
+    Allocator get_allocator() const {
+        return Allocator(alloc);
+    }
 
     /*
      * Test whether val belongs to the Set
      * Return true if val belongs to the set, otherwise false
-     * This function does not modify the Set in any way
+     * This function does not modify the values of the Set, but with a Bloom filter it may rebuild
+     * the filter and it updates bloom_stats: concurrent calls on the same Set then need a lock
+     */
+    bool is_member(const T& val) const;
+
+    /*
+     * Put a Bloom filter in front of is_member, so that most absent values are rejected in O(1)
+     * The filter is updated by each insertion and rebuilt lazily after values are removed
+     * Only if equivalent values are equal (Compare is operator< or operator>), since the filter
+     * hashes the values: an equivalent but different value would be rejected
+     * \param fp_rate desired false positive rate of the filter
+     */
+    void enable_bloom_filter(double fp_rate = 0.01)
+        requires is_equality_order_v<T, Compare>;
+
+    /*
+     * Remove the Bloom filter, if any
+     */
+    void disable_bloom_filter();
+
+    bool has_bloom_filter() const {
+        return bloom != nullptr;
+    }
+
+    /*
+     * Return the counters of the Bloom filter, collected by is_member
      */
-    bool is_member(int val) const;
+    BloomStats bloom_stats() const {
+        return bloom_counters;
+    }
+
+    void reset_bloom_stats() {
+        bloom_counters = BloomStats{};
+    }
+
+    /*
+     * Maintain a MinHash sketch of the Set, to estimate its similarity to other Sets in O(1)
+     * The sketch is updated by each insertion and rebuilt lazily after values are removed
+     * Only if equivalent values are equal (Compare is operator< or operator>), since the sketch
+     * hashes the values: equivalent but different values would not be counted as common
+     */
+    void enable_sketch()
+        requires is_equality_order_v<T, Compare>;
+
+    /*
+     * Stop maintaining the MinHash sketch, if any
+     */
+    void disable_sketch();
+
+    bool has_sketch() const {
+        return minhash != nullptr;
+    }
+
+    /*
+     * Return the MinHash sketch of the Set
+     * O(1) if the sketch is maintained and no values were removed since it was built, otherwise O(n)
+     * A maintained sketch may be rebuilt: concurrent calls on the same Set then need a lock
+     */
+    MinHash sketch() const
+        requires is_equality_order_v<T, Compare>;
+
+    /*
+     * Return the Jaccard similarity of Sets *this and S, i.e. |*this * S| / |*this + S|
+     * Two empty Sets have similarity 1
+     * Both Sets are merged in one pass, no Nodes are created
+     */
+    double similarity(const BasicSet& S) const;
 
     /*
      * Test whether the Set is empty
@@ -81,6 +256,56 @@ public:
         return counter;
     }
 
+    /*
+     * Return a 64-bit hash of the values of the Set, i.e. equal Sets have equal hashes
+     * It does not depend on the order in which values were inserted and removed,
+     * and it is maintained in O(1) by each insertion and removal
+     * Only if equivalent values are equal (Compare is operator< or operator>): otherwise equal Sets,
+     * e.g. {3} and {-3} ordered by absolute value, would have different hashes
+     */
+    std::uint64_t hash() const
+        requires is_equality_order_v<T, Compare>
+    {
+        return fingerprint;
+    }
+
+    /*
+     * Iterators to the smallest value and past the largest value of the Set
+     */
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /* Order statistics
+     *
+     * The queries below use an order-statistic index of the Nodes (rankindex.h), built by the first
+     * query in O(n) and then maintained by each insertion and removal in O(log n) expected
+     * The queries run in O(log n) expected
+     * An operation that changes more than about n / log n values without a query in between drops
+     * the index instead, so that it stays linear, and the next query rebuilds it
+     */
+
+    /*
+     * Return the number of values in the Set smaller than val
+     */
+    size_t rank(const T& val) const;
+
+    /*
+     * Return the k-th smallest value in the Set, counting from k = 0
+     * \param k must be smaller than cardinality()
+     */
+    const T& select(size_t k) const;
+
+    /*
+     * Return the number of values v in the Set such that lo <= v <= hi
+     */
+    size_t count_range(const T& lo, const T& hi) const;
+
+    /*
+     * Return the iterators to the values v in the Set such that lo <= v <= hi
+     * No values are copied
+     */
+    std::ranges::subrange<const_iterator> range(const T& lo, const T& hi) const;
+
 
     /*
      * Three-way comparison operator: to test whether *this == S, *this < S, *this > S
@@ -88,37 +313,80 @@ public:
      * Return std::partial_ordering::less, if *this < S (*this is contained in Set S)
      * Return std::partial_ordering::greater, if *this > S (*this constains Set S)
      * Return std::partial_ordering::unordered, otherwise (Sets *this and S are not comparable)
-     * 
+     *
      * Requirement: S1<=>S2 should iterate through each set S1 and S2 no more than once
      */
-    std::partial_ordering operator<=>(const Set& S) const;
+    std::partial_ordering operator<=>(const BasicSet& S) const;
 
     /*
      * Test whether Set *this and S represent the same set
      * Return true, if *this has same elements as set S
      * Return false, otherwise
-     * 
+     * Sets of different cardinality or hash are rejected in O(1)
+     *
      * Requirement: S1 == S2 should iterate through each set S1 and S2 no more than once
      */
-    bool operator==(const Set& S) const;
+    bool operator==(const BasicSet& S) const;
 
     /*
      * Modify Set *this such that it becomes the union of *this with Set S
      * Set *this is modified and then returned
      */
-    Set& operator+=(const Set& S);
+    BasicSet& operator+=(const BasicSet& S);
 
     /*
      * Modify Set *this such that it becomes the intersection of *this with Set S
      * Set *this is modified and then returned
      */
-    Set& operator*=(const Set& S);
+    BasicSet& operator*=(const BasicSet& S);
 
     /*
      * Modify Set *this such that it becomes the Set difference between Set *this and Set S
      * Set *this is modified and then returned
      */
-    Set& operator-=(const Set& S);
+    BasicSet& operator-=(const BasicSet& S);
+
+    /*
+     * Insert all values of the batch into Set *this
+     * \param values values in any order, possibly with repetitions
+     * The batch is sorted and then merged with the list in one pass
+     * Set *this is modified and then returned
+     */
+    BasicSet& insert_batch(std::span<const T> values);
+
+    /*
+     * Remove all values of the batch from Set *this
+     * \param values values in any order, possibly with repetitions
+     * The batch is sorted and then merged with the list in one pass
+     * Set *this is modified and then returned
+     */
+    BasicSet& erase_batch(std::span<const T> values);
+
+    /*
+     * Modify Set *this such that it becomes the union, intersection, or difference
+     * of *this with the Set viewed by V
+     * V is decoded in one pass, without creating Nodes for it
+     */
+    BasicSet& operator+=(const SetView& V)
+        requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>);
+    BasicSet& operator*=(const SetView& V)
+        requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>);
+    BasicSet& operator-=(const SetView& V)
+        requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>);
+
+    /*
+     * Write Set *this to stream os in the binary format of setview.h
+     * os should be opened in binary mode
+     */
+    void write_binary(std::ostream& os) const
+        requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>);
+
+    /*
+     * Read a Set in the binary format of setview.h from stream is
+     * The stream failbit is set if the input is not valid
+     */
+    static BasicSet read_binary(std::istream& is)
+        requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>);
 
     /*
      * Return number of existing nodes
@@ -134,7 +402,7 @@ public:
      * Overloaded operator<<
      * \param os ostream object where the set S elements are written
      */
-    friend std::ostream& operator<<(std::ostream& os, const Set& S) {
+    friend std::ostream& operator<<(std::ostream& os, const BasicSet& S) {
         S.write_to_stream(os);
         return os;
     }
@@ -144,7 +412,7 @@ public:
      * S1+S2 is the Set of elements in Set S1 or in Set S2 (without repeated elements)
      * Return a new Set representing the union of S1 with S2, S1+S2
      */
-    friend Set operator+(Set S1, const Set& S2) {
+    friend BasicSet operator+(BasicSet S1, const BasicSet& S2) {
         return (S1 += S2);
     }
 
@@ -153,7 +421,7 @@ public:
      * S1*S2 is the Set of elements in both sets S1 and S2
      * Return a new Set representing the intersection of S1 with S2, S1*S2
      */
-    friend Set operator*(Set S1, const Set& S2) {
+    friend BasicSet operator*(BasicSet S1, const BasicSet& S2) {
         return (S1 *= S2);
     }
 
@@ -162,16 +430,51 @@ public:
      * S1-S2 is the Set of elements in Set S1 that do not belong to Set S2
      * Return a new Set representing the set difference S1-S2
      */
-    friend Set operator-(Set S1, const Set& S2) {
+    friend BasicSet operator-(BasicSet S1, const BasicSet& S2) {
         return (S1 -= S2);
     }
 
 private:
-    class Node;  // nested class defined in node.h
+    using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    // storage of a removed Node while it waits in the pool to be reused
+    struct Spare {
+        Spare* next;
+    };
 
     Node* head;      // pointer to the dummy header Node
     Node* tail;      // pointer to the dummy tail Node
     size_t counter;  // number of values in the Set
+    Spare* pool;     // storage of removed Nodes, kept for reuse
+
+    std::uint64_t fingerprint;  // sum of value_hash of all values, see hash()
+
+    [[no_unique_address]] Compare comp;          // ordering of the values
+    [[no_unique_address]] node_allocator alloc;  // allocator of the Nodes
+
+    mutable RankIndex<T, Node, Compare> rank_index;  // order statistics of the Nodes, used by rank and select
+    mutable bool rank_index_valid;                   // false if rank_index must be rebuilt before it is used
+    mutable size_t rank_index_updates;               // updates of rank_index since it was last used
+
+    std::unique_ptr<BloomFilter> bloom;  // filter in front of is_member, nullptr if disabled
+    mutable bool bloom_stale;            // true if bloom must be rebuilt before it is used
+    mutable BloomStats bloom_counters;
+
+    std::unique_ptr<MinHash> minhash;  // sketch of the values, nullptr if disabled
+    mutable bool minhash_stale;        // true if minhash must be rebuilt before it is used
+
+    // batches with at least this many values are sorted in parallel
+    static constexpr size_t parallel_sort_threshold = 1 << 16;
+
+    // values without std::hash, e.g. a struct of integers, are hashed byte-wise by hash_key
+    static constexpr bool has_std_hash = requires(const T& v) { std::hash<T>{}(v); };
+
+    // arithmetic values ordered by operator<: use the branch-light merge loops
+    static constexpr bool natural_order = is_natural_order_v<T, Compare>;
+
+    // equivalent values are equal, so they have equal hashes and operator== can compare hashes
+    static constexpr bool equivalence_is_equality = is_equality_order_v<T, Compare>;
 
     /* ************************** *
      * Private Member Functions    *
@@ -182,7 +485,7 @@ private:
      * \param p pointer to a Node
      * \param val value to be inserted  after position p
      */
-    void insert_node(Node* p, int val);
+    void insert_node(Node* p, const T& val);
 
     /*
      * Remove the Node pointed by p
@@ -190,8 +493,1156 @@ private:
      */
     void remove_node(Node* p);
 
+    /*
+     * Create a Node, reusing storage from the pool when possible
+     */
+    Node* get_node(const T& val, Node* nextPtr, Node* prevPtr);
+
+    /*
+     * Destroy the Node pointed by p and keep its storage in the pool
+     */
+    void put_node(Node* p);
+
+    /*
+     * Deallocate all storage kept in the pool
+     */
+    void release_pool();
+
+    /*
+     * Exchange the contents of *this and S
+     */
+    void swap_contents(BasicSet& S);
+
+    /*
+     * Return true if a and b are equivalent, i.e. neither is ordered before the other
+     */
+    bool equivalent(const T& a, const T& b) const {
+        if constexpr (natural_order) {
+            return a == b;
+        } else {
+            return !comp(a, b) && !comp(b, a);
+        }
+    }
+
+    /*
+     * Return the values sorted increasingly and without repetitions
+     */
+    std::vector<T> sort_batch(std::span<const T> values) const;
+
+    /*
+     * Return the 64-bit key of val used by the Bloom filter and the fingerprint
+     */
+    static std::uint64_t hash_key(const T& val) {
+        if constexpr (std::is_integral_v<T>) {
+            return static_cast<std::uint64_t>(val);
+        } else if constexpr (has_std_hash) {
+            return static_cast<std::uint64_t>(std::hash<T>{}(val));
+        } else {
+            static_assert(std::has_unique_object_representations_v<T>,
+                          "T needs a std::hash specialization or a unique object representation");
+            // FNV-1a over the bytes of val: equal values have equal bytes, since T has no padding
+            std::uint64_t h = 0xCBF29CE484222325ULL;
+            for (std::byte b : std::as_bytes(std::span{&val, 1})) {
+                h = (h ^ static_cast<std::uint64_t>(b)) * 0x100000001B3ULL;
+            }
+            return h;
+        }
+    }
+
+    /*
+     * Return the contribution of val to the fingerprint
+     * Summing mixed hashes makes the fingerprint independent of the order of the values
+     */
+    static std::uint64_t value_hash(const T& val) {
+        return mix64(hash_key(val) ^ 0x2545F4914F6CDD1DULL);
+    }
+
+    /*
+     * Rebuild bloom with all values of the Set, if it is stale
+     */
+    void update_bloom_filter() const;
+
+    /*
+     * Rebuild minhash with all values of the Set, if it is stale
+     */
+    void update_sketch() const;
+
+    /*
+     * Rebuild rank_index, if it was dropped
+     */
+    void update_rank_index() const;
+
+    /*
+     * Return true if rank_index follows one more update of the Set, false if it was dropped
+     */
+    bool keep_rank_index();
+
     /*
      * Write Set *this to stream os
      */
     void write_to_stream(std::ostream& os) const;
-};
\ No newline at end of file
+};
+
+/*
+ * A Set of ints, as used in lab2.cpp
+ */
+using Set = BasicSet<int>;
+
+namespace pmr {
+
+/*
+ * A Set whose Nodes are allocated from a std::pmr::memory_resource
+ * Usage: std::pmr::monotonic_buffer_resource pool; pmr::Set<long long> S{&pool};
+ */
+template <class T, class Compare = std::less<T>>
+using Set = BasicSet<T, Compare, std::pmr::polymorphic_allocator<T>>;
+
+}  // namespace pmr
+
+#include "node.h"
+
+/* ******************************************** *
+ * Set::const_iterator -- Implementation        *
+ * ******************************************** */
+
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::const_iterator::reference
+BasicSet<T, Compare, Allocator>::const_iterator::operator*() const {
+    return ptr->value;
+}
+
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::const_iterator&
+BasicSet<T, Compare, Allocator>::const_iterator::operator++() {
+    ptr = ptr->next;
+    return *this;
+}
+
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::const_iterator
+BasicSet<T, Compare, Allocator>::const_iterator::operator++(int) {
+    const_iterator tmp{*this};
+    ptr = ptr->next;
+    return tmp;
+}
+
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::const_iterator&
+BasicSet<T, Compare, Allocator>::const_iterator::operator--() {
+    ptr = ptr->prev;
+    return *this;
+}
+
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::const_iterator
+BasicSet<T, Compare, Allocator>::const_iterator::operator--(int) {
+    const_iterator tmp{*this};
+    ptr = ptr->prev;
+    return tmp;
+}
+
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::const_iterator BasicSet<T, Compare, Allocator>::begin() const {
+    return const_iterator{head->next};
+}
+
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::const_iterator BasicSet<T, Compare, Allocator>::end() const {
+    return const_iterator{tail};
+}
+
+/*****************************************************
+ * Implementation of the member functions             *
+ ******************************************************/
+
+/*
+ * Return number of existing nodes
+ */
+template <class T, class Compare, class Allocator>
+int BasicSet<T, Compare, Allocator>::get_count_nodes() { // O(1)
+    return Node::count_nodes;
+}
+
+/*
+ *  Default constructor :create an empty Set
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet() : BasicSet{Allocator{}} {} // O(1)
+
+/*
+ *  Constructor: create an empty Set whose Nodes are allocated with alloc
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const Allocator& a)
+    : counter{0}, pool{nullptr}, fingerprint{0}, comp{}, alloc{a}, rank_index_valid{false}, rank_index_updates{0},
+      bloom_stale{false}, minhash_stale{false} { // O(1)
+    // IMPLEMENT before Lab2 HA
+    head = get_node(T{}, nullptr, nullptr);
+    tail = get_node(T{}, nullptr, nullptr);
+
+    head->next = tail;
+    tail->prev = head;
+}
+
+/*
+ *  Conversion constructor: convert val into a singleton {val}
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const T& val) : BasicSet{} {  // create an empty list // O(1)
+    // IMPLEMENT before Lab2 HA
+    insert_node(tail, val);
+}
+
+/*
+ * Constructor to create a Set from a sorted vector of unique values
+ * \param list_of_values is an increasingly sorted vector of unique values
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const std::vector<T>& list_of_values) : BasicSet{} {  // create an empty list // O(n)
+    // IMPLEMENT before Lab2 HA
+    for (const T& val : list_of_values) {
+        insert_node(tail, val);
+    }
+}
+
+/*
+ * Constructor to create a Set from a vector of values in any order
+ * \param list_of_values vector of values, possibly unsorted and with repetitions
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const std::vector<T>& list_of_values, unsorted_t) : BasicSet{} {  // O(n log n)
+    for (const T& val : sort_batch(list_of_values)) {
+        insert_node(tail, val);
+    }
+}
+
+/*
+ * Constructor to create a Set with the values of a SetView
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const SetView& V)
+    requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>)
+    : BasicSet{} {  // O(n)
+    for (int val : V) {
+        insert_node(tail, val);
+    }
+}
+
+/*
+ * Copy constructor: create a new Set as a copy of Set S
+ * \param S Set to copied
+ * Function does not modify Set S in any way
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const BasicSet& S)
+    : BasicSet{Allocator(node_traits::select_on_container_copy_construction(S.alloc))} {  // create an empty list // O(n)
+    // IMPLEMENT before Lab2 HA
+    comp = S.comp;
+    Node* current = S.head->next;
+    while (current != S.tail) {
+        insert_node(tail, current->value);
+        current = current->next;
+    }
+
+    if constexpr (equivalence_is_equality) {
+        if (S.has_bloom_filter()) {
+            enable_bloom_filter(S.bloom->false_positive_rate());
+        }
+    }
+    if constexpr (equivalence_is_equality) {
+        if (S.has_sketch()) {
+            enable_sketch();
+        }
+    }
+}
+
+/*
+ * Transform the Set into an empty set
+ * Remove all nodes from the list, except the dummy nodes
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::make_empty() { // O(n)
+    // IMPLEMENT before Lab2 HA
+    Node* current = head->next;
+    while (current != tail) {
+        Node* temp = current;
+        current = current->next;
+        remove_node(temp);
+    }
+    counter = 0;
+}
+
+/*
+ * Destructor: deallocate all memory (Nodes) allocated for the list
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>::~BasicSet() { // O(n)
+    // IMPLEMENT before Lab2 HA
+    make_empty();
+    remove_node(head);
+    remove_node(tail);
+    release_pool();
+}
+
+/*
+ * Assignment operator: assign new contents to the *this Set, replacing its current content
+ * \param S Set to be copied into Set *this
+ * Use copy-and swap idiom -- TNG033: lecture 5
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator=(BasicSet S) { // O(1)?
+    // IMPLEMENT before Lab2 HA
+    if (node_traits::propagate_on_container_swap::value || alloc == S.alloc) {
+        swap_contents(S);
+        return *this;
+    }
+
+    // Nodes of S cannot be owned by *this: copy the values, O(n)
+    make_empty();
+    comp = S.comp;
+    for (Node* p = S.head->next; p != S.tail; p = p->next) {
+        insert_node(tail, p->value);
+    }
+    if constexpr (equivalence_is_equality) {
+        if (S.has_bloom_filter()) {
+            enable_bloom_filter(S.bloom->false_positive_rate());
+        } else {
+            disable_bloom_filter();
+        }
+    }
+    if constexpr (equivalence_is_equality) {
+        if (S.has_sketch()) {
+            enable_sketch();
+        } else {
+            disable_sketch();
+        }
+    }
+    return *this;
+}
+
+/*
+ * Test whether val belongs to the Set
+ * Return true if val belongs to the set, otherwise false
+ * This function does not modify the values of the Set
+ */
+template <class T, class Compare, class Allocator>
+bool BasicSet<T, Compare, Allocator>::is_member(const T& val) const { // O(n), O(1) if rejected by the Bloom filter
+    // IMPLEMENT before Lab2 HA
+    if constexpr (equivalence_is_equality) {
+        if (bloom != nullptr) {
+            update_bloom_filter();
+            if (!bloom->may_contain(hash_key(val))) {
+                ++bloom_counters.misses;
+                return false;
+            }
+        }
+    }
+
+    bool found = false;
+    Node* current = head->next;
+    while (current != tail) {
+        if (!comp(current->value, val)) {
+            found = !comp(val, current->value);
+            break; // Early exit since list is sorted
+        }
+        current = current->next;
+    }
+
+    if (bloom != nullptr) {
+        ++(found ? bloom_counters.hits : bloom_counters.false_positives);
+    }
+    return found;
+}
+
+/*
+ * Put a Bloom filter in front of is_member, so that most absent values are rejected in O(1)
+ * \param fp_rate desired false positive rate of the filter
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::enable_bloom_filter(double fp_rate)
+    requires is_equality_order_v<T, Compare>
+{ // O(1), the filter is built by the next is_member
+    bloom = std::make_unique<BloomFilter>(counter, fp_rate);
+    bloom_stale = true;
+    bloom_counters = BloomStats{};
+}
+
+/*
+ * Remove the Bloom filter, if any
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::disable_bloom_filter() { // O(1)
+    bloom.reset();
+    bloom_stale = false;
+}
+
+/*
+ * Maintain a MinHash sketch of the Set
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::enable_sketch()
+    requires is_equality_order_v<T, Compare>
+{ // O(1), the sketch is built when it is first used
+    minhash = std::make_unique<MinHash>();
+    minhash_stale = true;
+}
+
+/*
+ * Stop maintaining the MinHash sketch, if any
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::disable_sketch() { // O(1)
+    minhash.reset();
+    minhash_stale = false;
+}
+
+/*
+ * Return the MinHash sketch of the Set
+ */
+template <class T, class Compare, class Allocator>
+MinHash BasicSet<T, Compare, Allocator>::sketch() const
+    requires is_equality_order_v<T, Compare>
+{ // O(1) if maintained, otherwise O(n)
+    if (minhash != nullptr) {
+        update_sketch();
+        return *minhash;
+    }
+
+    MinHash M;
+    for (Node* p = head->next; p != tail; p = p->next) {
+        M.insert(hash_key(p->value));
+    }
+    return M;
+}
+
+/*
+ * Return the Jaccard similarity of Sets *this and S
+ * Same merge as operator*=, but the common values are only counted
+ */
+template <class T, class Compare, class Allocator>
+double BasicSet<T, Compare, Allocator>::similarity(const BasicSet& S) const { // O(n)
+    size_t n_common = 0;
+    Node* p1 = head->next;
+    Node* p2 = S.head->next;
+
+    while (p1 != tail && p2 != S.tail) {
+        if (comp(p1->value, p2->value)) {
+            p1 = p1->next;
+        } else if (comp(p2->value, p1->value)) {
+            p2 = p2->next;
+        } else {
+            ++n_common;
+            p1 = p1->next;
+            p2 = p2->next;
+        }
+    }
+
+    const size_t n_union = counter + S.counter - n_common;
+    return (n_union == 0) ? 1.0 : static_cast<double>(n_common) / static_cast<double>(n_union);
+}
+
+/*
+ * Three-way comparison operator: to test whether *this == S, *this < S, *this > S
+ * Return std::partial_ordering::equivalent, if *this == S
+ * Return std::partial_ordering::less, if *this < S
+ * Return std::partial_ordering::greater, if *this > S
+ * Return std::partial_ordering::unordered, otherwise
+ *
+ * Requirement: must iterate through each set no more than once
+ */
+template <class T, class Compare, class Allocator>
+std::partial_ordering BasicSet<T, Compare, Allocator>::operator<=>(const BasicSet& S) const { // O(n)
+    // IMPLEMENT before Lab2 HA
+    Node* p1 = head->next;
+    Node* p2 = S.head->next;
+    bool less_than = true;
+    bool greater_than = true;
+
+    if constexpr (natural_order) {
+        // branch-light loop: the comparisons select the next Nodes instead of jumping
+        while (p1 != tail && p2 != S.tail) {
+            const bool lt = p1->value < p2->value;
+            const bool gt = p2->value < p1->value;
+            less_than &= !lt;
+            greater_than &= !gt;
+            p1 = gt ? p1 : p1->next;
+            p2 = lt ? p2 : p2->next;
+        }
+    } else {
+        while (p1 != tail && p2 != S.tail) {
+            if (comp(p1->value, p2->value)) {
+                less_than = false;
+                p1 = p1->next;
+            }
+            else if (comp(p2->value, p1->value)) {
+                greater_than = false;
+                p2 = p2->next;
+            }
+            else {
+                p1 = p1->next;
+                p2 = p2->next;
+            }
+        }
+    }
+
+    // checks if there is still slots unexplored
+
+    if (p1 != tail) {
+        less_than = false;
+    }
+    if (p2 != S.tail) {
+        greater_than = false;
+    }
+
+    if (less_than && greater_than) {
+        return std::partial_ordering::equivalent;
+    }
+    else if (less_than) {
+        return std::partial_ordering::less;
+    }
+    else if (greater_than) {
+        return std::partial_ordering::greater;
+    }
+    else {
+        return std::partial_ordering::unordered;
+    }
+}
+
+/*
+ * Test whether Set *this and S represent the same set
+ * Return true, if *this has same elemnts as set S
+ * Return false, otherwise
+ *
+ * Requirement: must iterate through each set no more than once
+ */
+template <class T, class Compare, class Allocator>
+bool BasicSet<T, Compare, Allocator>::operator==(const BasicSet& S) const { // O(n), O(1) if not equal
+    // IMPLEMENT before Lab2 HA
+    if (counter != S.counter) {
+        return false;
+    }
+    if constexpr (equivalence_is_equality) {
+        if (fingerprint != S.fingerprint) {
+            return false;
+        }
+    }
+    return (*this <=> S) == std::partial_ordering::equivalent;
+}
+
+/*
+ * Modify Set *this such that it becomes the union of *this with Set S
+ * Set *this is modified and then returned
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator+=(const BasicSet& S) { // O(n), O(n + m)
+    // IMPLEMENT
+    Node* p1 = head->next;
+    Node* p2 = S.head->next;
+
+    if constexpr (natural_order) {
+        // branch-light loop: the comparisons select the next Nodes, only insertions jump
+        while (p1 != tail && p2 != S.tail) {
+            const bool lt = p1->value < p2->value;
+            const bool gt = p2->value < p1->value;
+            if (gt) {
+                insert_node(p1, p2->value);
+            }
+            p1 = gt ? p1 : p1->next;
+            p2 = lt ? p2 : p2->next;
+        }
+    } else {
+        while (p1 != tail && p2 != S.tail) {
+            if (comp(p1->value, p2->value)) {
+                p1 = p1->next;
+            }
+            else if (comp(p2->value, p1->value)) {
+                insert_node(p1, p2->value);
+                p2 = p2->next;
+            }
+            else {
+                p1 = p1->next;
+                p2 = p2->next;
+            }
+        }
+    }
+
+    while (p2 != S.tail) {
+        insert_node(tail, p2->value);
+        p2 = p2->next;
+    }
+    return *this;
+}
+
+/*
+ * Modify Set *this such that it becomes the intersection of *this with Set S
+ * Set *this is modified and then returned
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator*=(const BasicSet& S) { // O(n), O(n + m)
+    // IMPLEMENT
+    Node* p1 = head->next;
+    Node* p2 = S.head->next;
+
+    if constexpr (natural_order) {
+        // branch-light loop: the comparisons select the next Nodes, only removals jump
+        while (p1 != tail && p2 != S.tail) {
+            const bool lt = p1->value < p2->value;
+            const bool gt = p2->value < p1->value;
+            Node* current = p1;
+            p1 = gt ? p1 : p1->next;
+            p2 = lt ? p2 : p2->next;
+            if (lt) {
+                remove_node(current);
+            }
+        }
+    } else {
+        while (p1 != tail && p2 != S.tail) {
+            if (comp(p1->value, p2->value)) {
+                Node* to_delete = p1;
+                p1 = p1->next;
+                remove_node(to_delete);
+            }
+            else if (comp(p2->value, p1->value)) {
+                p2 = p2->next;
+            }
+            else {
+                p1 = p1->next;
+                p2 = p2->next;
+            }
+        }
+    }
+
+    while (p1 != tail) {
+        Node* to_delete = p1;
+        p1 = p1->next;
+        remove_node(to_delete);
+    }
+
+    return *this;
+}
+
+/*
+ * Modify Set *this such that it becomes the Set difference between Set *this and Set S
+ * Set *this is modified and then returned
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator-=(const BasicSet& S) { // O(n), O(n + m)
+    // IMPLEMENT
+    Node* p1 = head->next;
+    Node* p2 = S.head->next;
+
+    if constexpr (natural_order) {
+        // branch-light loop: the comparisons select the next Nodes, only removals jump
+        while (p1 != tail && p2 != S.tail) {
+            const bool lt = p1->value < p2->value;
+            const bool gt = p2->value < p1->value;
+            Node* current = p1;
+            p1 = gt ? p1 : p1->next;
+            p2 = lt ? p2 : p2->next;
+            if (!lt && !gt) {
+                remove_node(current);
+            }
+        }
+    } else {
+        while (p1 != tail && p2 != S.tail) {
+            if (comp(p1->value, p2->value)) {
+                p1 = p1->next;
+            }
+            else if (comp(p2->value, p1->value)) {
+                p2 = p2->next;
+            }
+            else {
+                Node* to_delete = p1;
+                p1 = p1->next;
+                p2 = p2->next;
+                remove_node(to_delete);
+            }
+        }
+    }
+    return *this;
+}
+
+/*
+ * Insert all values of the batch into Set *this
+ * \param values values in any order, possibly with repetitions
+ * The batch is sorted and then merged with the list in one pass
+ * Set *this is modified and then returned
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::insert_batch(std::span<const T> values) { // O(k log k + n)
+    const std::vector<T> batch = sort_batch(values);
+    Node* p1 = head->next;
+    auto it = batch.begin();
+
+    while (p1 != tail && it != batch.end()) {
+        if (comp(p1->value, *it)) {
+            p1 = p1->next;
+        }
+        else if (comp(*it, p1->value)) {
+            insert_node(p1, *it);
+            ++it;
+        }
+        else {
+            p1 = p1->next;
+            ++it;
+        }
+    }
+
+    for (; it != batch.end(); ++it) {
+        insert_node(tail, *it);
+    }
+    return *this;
+}
+
+/*
+ * Remove all values of the batch from Set *this
+ * \param values values in any order, possibly with repetitions
+ * The batch is sorted and then merged with the list in one pass
+ * Set *this is modified and then returned
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::erase_batch(std::span<const T> values) { // O(k log k + n)
+    const std::vector<T> batch = sort_batch(values);
+    Node* p1 = head->next;
+    auto it = batch.begin();
+
+    while (p1 != tail && it != batch.end()) {
+        if (comp(p1->value, *it)) {
+            p1 = p1->next;
+        }
+        else if (comp(*it, p1->value)) {
+            ++it;
+        }
+        else {
+            Node* to_delete = p1;
+            p1 = p1->next;
+            ++it;
+            remove_node(to_delete);
+        }
+    }
+    return *this;
+}
+
+/*
+ * Modify Set *this such that it becomes the union of *this with the Set viewed by V
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator+=(const SetView& V)
+    requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>)
+{ // O(n + m)
+    Node* p1 = head->next;
+    auto p2 = V.begin();
+
+    while (p1 != tail && p2 != V.end()) {
+        if (p1->value < *p2) {
+            p1 = p1->next;
+        }
+        else if (p1->value > *p2) {
+            insert_node(p1, *p2);
+            ++p2;
+        }
+        else {
+            p1 = p1->next;
+            ++p2;
+        }
+    }
+
+    for (; p2 != V.end(); ++p2) {
+        insert_node(tail, *p2);
+    }
+    return *this;
+}
+
+/*
+ * Modify Set *this such that it becomes the intersection of *this with the Set viewed by V
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator*=(const SetView& V)
+    requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>)
+{ // O(n + m)
+    Node* p1 = head->next;
+    auto p2 = V.begin();
+
+    while (p1 != tail && p2 != V.end()) {
+        if (p1->value < *p2) {
+            Node* to_delete = p1;
+            p1 = p1->next;
+            remove_node(to_delete);
+        }
+        else if (p1->value > *p2) {
+            ++p2;
+        }
+        else {
+            p1 = p1->next;
+            ++p2;
+        }
+    }
+
+    while (p1 != tail) {
+        Node* to_delete = p1;
+        p1 = p1->next;
+        remove_node(to_delete);
+    }
+    return *this;
+}
+
+/*
+ * Modify Set *this such that it becomes the difference between *this and the Set viewed by V
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator-=(const SetView& V)
+    requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>)
+{ // O(n + m)
+    Node* p1 = head->next;
+    auto p2 = V.begin();
+
+    while (p1 != tail && p2 != V.end()) {
+        if (p1->value < *p2) {
+            p1 = p1->next;
+        }
+        else if (p1->value > *p2) {
+            ++p2;
+        }
+        else {
+            Node* to_delete = p1;
+            p1 = p1->next;
+            ++p2;
+            remove_node(to_delete);
+        }
+    }
+    return *this;
+}
+
+/*
+ * Return the number of values in the Set smaller than val
+ */
+template <class T, class Compare, class Allocator>
+size_t BasicSet<T, Compare, Allocator>::rank(const T& val) const { // O(log n) expected, O(n) if the index was dropped
+    update_rank_index();
+    return rank_index.lower_bound(val, comp);
+}
+
+/*
+ * Return the k-th smallest value in the Set, counting from k = 0
+ */
+template <class T, class Compare, class Allocator>
+const T& BasicSet<T, Compare, Allocator>::select(size_t k) const { // O(log n) expected, O(n) if the index was dropped
+    assert(k < counter);
+    update_rank_index();
+    return rank_index.select(k)->value;
+}
+
+/*
+ * Return the number of values v in the Set such that lo <= v <= hi
+ */
+template <class T, class Compare, class Allocator>
+size_t BasicSet<T, Compare, Allocator>::count_range(const T& lo, const T& hi) const { // O(log n) expected, O(n) if the index was dropped
+    if (comp(hi, lo)) {
+        return 0;
+    }
+    update_rank_index();
+    return rank_index.upper_bound(hi, comp) - rank_index.lower_bound(lo, comp);
+}
+
+/*
+ * Return the iterators to the values v in the Set such that lo <= v <= hi
+ */
+template <class T, class Compare, class Allocator>
+std::ranges::subrange<typename BasicSet<T, Compare, Allocator>::const_iterator>
+BasicSet<T, Compare, Allocator>::range(const T& lo, const T& hi) const { // O(log n) expected, O(n) if the index was dropped
+    if (comp(hi, lo)) {
+        return {end(), end()};
+    }
+    update_rank_index();
+    const size_t first = rank_index.lower_bound(lo, comp);
+    const size_t last = rank_index.upper_bound(hi, comp);
+
+    auto at = [this](size_t i) { return const_iterator{i < counter ? rank_index.select(i) : tail}; };
+    return {at(first), at(last)};
+}
+
+/*
+ * Write Set *this to stream os in the binary format of setview.h
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::write_binary(std::ostream& os) const
+    requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>)
+{ // O(n)
+    SetEncoder encoder{os};
+    for (Node* p = head->next; p != tail; p = p->next) {
+        encoder.push(p->value);
+    }
+    encoder.finish();
+}
+
+/*
+ * Read a Set in the binary format of setview.h from stream is
+ * The stream failbit is set if the input is not valid
+ */
+template <class T, class Compare, class Allocator>
+BasicSet<T, Compare, Allocator> BasicSet<T, Compare, Allocator>::read_binary(std::istream& is)
+    requires(std::is_same_v<T, int> && is_natural_order_v<T, Compare>)
+{ // O(n)
+    BasicSet S;
+    SetDecoder decoder{is};
+    int val;
+    while (decoder.next(val)) {
+        if (!S.is_empty() && val <= S.tail->prev->value) {  // values must be increasing
+            is.setstate(std::ios::failbit);
+            break;
+        }
+        S.insert_node(S.tail, val);
+    }
+    return S;
+}
+
+
+/* ******************************************** *
+ * Private Member Functions -- Implementation   *
+ * ******************************************** */
+
+/*
+ * Insert a new Node storing val before the Node pointed by p
+ * \param p pointer to a Node
+ * \param val value to be inserted before position p
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::insert_node(Node* p, const T& val) { // O(1)
+    // IMPLEMENT before Lab2 HA
+    Node* newNode = get_node(val, p, p->prev);  // value of place, pointer to next node (tail), pointer to previous node
+    p->prev->next = newNode;
+    p->prev = newNode;
+    ++counter;
+    fingerprint += value_hash(val);
+    if (keep_rank_index()) {
+        rank_index.insert(newNode, comp);
+    }
+
+    if (bloom != nullptr && !bloom_stale) {
+        if (counter > bloom->capacity()) {
+            bloom_stale = true;  // grow the filter to keep the false positive rate
+        } else {
+            bloom->insert(hash_key(val));
+        }
+    }
+    if (minhash != nullptr && !minhash_stale) {
+        minhash->insert(hash_key(val));
+    }
+}
+
+/*
+ * Remove the Node pointed by p
+ * \param p pointer to a Node
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::remove_node(Node* p) { // O(1)
+    // IMPLEMENT before Lab2 HA
+    if (p == nullptr) return;
+
+    if (p->prev != nullptr) {
+        p->prev->next = p->next;
+    }
+    if (p->next != nullptr) {
+        p->next->prev = p->prev;
+    }
+
+    // Only decrement counter for real nodes
+    if (p != head && p != tail) {
+        --counter;
+        fingerprint -= value_hash(p->value);
+        if (keep_rank_index()) {
+            rank_index.erase(p->value, comp);
+        }
+        bloom_stale = (bloom != nullptr);  // values cannot be removed from a Bloom filter
+        minhash_stale = (minhash != nullptr);
+    }
+
+    put_node(p);
+}
+
+/*
+ * Create a Node, reusing storage from the pool when possible
+ */
+template <class T, class Compare, class Allocator>
+typename BasicSet<T, Compare, Allocator>::Node*
+BasicSet<T, Compare, Allocator>::get_node(const T& val, Node* nextPtr, Node* prevPtr) { // O(1)
+    Node* storage;
+    if (pool != nullptr) {
+        storage = reinterpret_cast<Node*>(pool);
+        pool = pool->next;
+    } else {
+        storage = node_traits::allocate(alloc, 1);
+    }
+    node_traits::construct(alloc, storage, val, nextPtr, prevPtr);
+    return storage;
+}
+
+/*
+ * Destroy the Node pointed by p and keep its storage in the pool
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::put_node(Node* p) { // O(1)
+    static_assert(sizeof(Spare) <= sizeof(Node) && alignof(Spare) <= alignof(Node));
+    node_traits::destroy(alloc, p);
+    pool = ::new (static_cast<void*>(p)) Spare{pool};
+}
+
+/*
+ * Deallocate all storage kept in the pool
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::release_pool() { // O(n)
+    while (pool != nullptr) {
+        Node* storage = reinterpret_cast<Node*>(pool);
+        pool = pool->next;
+        node_traits::deallocate(alloc, storage, 1);
+    }
+}
+
+/*
+ * Exchange the contents of *this and S
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::swap_contents(BasicSet& S) { // O(1)
+    std::swap(head, S.head);
+    std::swap(tail, S.tail);
+    std::swap(counter, S.counter);
+    std::swap(pool, S.pool);
+    std::swap(fingerprint, S.fingerprint);
+    std::swap(comp, S.comp);
+    if constexpr (node_traits::propagate_on_container_swap::value) {
+        std::swap(alloc, S.alloc);
+    }
+    std::swap(rank_index, S.rank_index);
+    std::swap(rank_index_valid, S.rank_index_valid);
+    std::swap(rank_index_updates, S.rank_index_updates);
+    std::swap(bloom, S.bloom);
+    std::swap(bloom_stale, S.bloom_stale);
+    std::swap(bloom_counters, S.bloom_counters);
+    std::swap(minhash, S.minhash);
+    std::swap(minhash_stale, S.minhash_stale);
+}
+
+/*
+ * Return the values sorted increasingly and without repetitions
+ */
+template <class T, class Compare, class Allocator>
+std::vector<T> BasicSet<T, Compare, Allocator>::sort_batch(std::span<const T> values) const { // O(k log k)
+    std::vector<T> batch(values.begin(), values.end());
+
+    if (batch.size() >= parallel_sort_threshold) {
+        if constexpr (natural_order) {
+            std::sort(std::execution::par_unseq, batch.begin(), batch.end());
+        } else {
+            std::sort(std::execution::par, batch.begin(), batch.end(), comp);
+        }
+    } else {
+        std::sort(batch.begin(), batch.end(), comp);
+    }
+    batch.erase(std::unique(batch.begin(), batch.end(),
+                            [this](const T& a, const T& b) { return equivalent(a, b); }),
+                batch.end());
+    return batch;
+}
+
+/*
+ * Rebuild bloom with all values of the Set, if it is stale
+ * The filter gets room for 50% more values, so that insertions do not force a rebuild soon
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::update_bloom_filter() const { // O(n) if stale, otherwise O(1)
+    if (!bloom_stale) {
+        return;
+    }
+
+    *bloom = BloomFilter{std::max<size_t>(counter + counter / 2, 64), bloom->false_positive_rate()};
+    for (Node* p = head->next; p != tail; p = p->next) {
+        bloom->insert(hash_key(p->value));
+    }
+    bloom_stale = false;
+}
+
+/*
+ * Rebuild minhash with all values of the Set, if it is stale
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::update_sketch() const { // O(n) if stale, otherwise O(1)
+    if (!minhash_stale) {
+        return;
+    }
+
+    minhash->clear();
+    for (Node* p = head->next; p != tail; p = p->next) {
+        minhash->insert(hash_key(p->value));
+    }
+    minhash_stale = false;
+}
+
+/*
+ * Rebuild rank_index, if it was dropped
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::update_rank_index() const { // O(n) if it was dropped, otherwise O(1)
+    rank_index_updates = 0;
+    if (rank_index_valid) {
+        return;
+    }
+
+    rank_index.build(head->next, counter);
+    rank_index_valid = true;
+}
+
+/*
+ * Return true if rank_index follows one more update of the Set, false if it was dropped
+ * Beyond about n / log n updates without a query, rebuilding the index on the next query is cheaper
+ * than updating it, and operations on the whole Set stay linear
+ */
+template <class T, class Compare, class Allocator>
+bool BasicSet<T, Compare, Allocator>::keep_rank_index() { // O(1)
+    if (!rank_index_valid) {
+        return false;
+    }
+    if (++rank_index_updates > counter / (std::bit_width(counter) + 1)) {
+        rank_index.clear();
+        rank_index_valid = false;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Write Set *this to stream os
+ */
+template <class T, class Compare, class Allocator>
+void BasicSet<T, Compare, Allocator>::write_to_stream(std::ostream& os) const { // O(n)
+    if (is_empty()) {
+        os << "Set is empty!";
+    } else {
+        Node* ptr{head->next};
+
+        os << "{ ";
+        while (ptr != tail) {
+            os << ptr->value << " ";
+            ptr = ptr->next;
+        }
+        os << "}";
+    }
+}
+
+/*
+ * Hash of a Set, so that Sets can be keys of std::unordered_set and std::unordered_map
+ * O(1): the hash is maintained by the Set
+ * Only if equivalent values are equal, see BasicSet::hash
+ */
+template <class T, class Compare, class Allocator>
+    requires is_equality_order_v<T, Compare>
+struct std::hash<BasicSet<T, Compare, Allocator>> {
+    size_t operator()(const BasicSet<T, Compare, Allocator>& S) const noexcept {
+        return static_cast<size_t>(S.hash());
+    }
+};
+
+/*
+ * Set<int> is compiled once, in set.cpp
+ */
+extern template class BasicSet<int>;
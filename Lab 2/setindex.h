@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "set.h"
+
+/** Class to find near-duplicates of a Set among many stored Sets
+ *
+ * Locality-sensitive hashing of the MinHash sketches: the signature of a sketch is split into
+ * bands of rows values, and two Sets are candidates if all values of at least one band are equal
+ * Sets with Jaccard similarity J are candidates with probability 1 - (1 - J^rows)^bands,
+ * a steep curve around the threshold (1 / bands)^(1 / rows), e.g. 0.42 for 32 bands of 4 rows
+ * Candidates are then verified exactly with BasicSet::similarity
+ *
+ * The index stores pointers: the Sets must outlive the index and must not be modified
+ * while they are in it
+ * Only if equivalent values are equal, see BasicSet::enable_sketch: otherwise the sketches of
+ * near-duplicates differ, and they would be missed before the exact check
+ */
+template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    requires is_equality_order_v<T, Compare>
+class BasicSetIndex {
+public:
+    using set_type = BasicSet<T, Compare, Allocator>;
+
+    /*
+     * Constructor: create an empty index
+     * \param bands number of bands, must divide MinHash::n_bins
+     *        more bands give more candidates, i.e. find less similar Sets
+     */
+    explicit BasicSetIndex(size_t bands = 32);
+
+    /*
+     * Add Set S to the index
+     * Return the id of S in the index, i.e. the number of Sets added before S
+     * O(bands), plus O(n) if S does not maintain a sketch
+     */
+    size_t insert(const set_type& S);
+
+    /*
+     * Return the Set with the given id
+     */
+    const set_type& operator[](size_t id) const {
+        return *sets[id];
+    }
+
+    /*
+     * Number of Sets in the index
+     */
+    size_t size() const {
+        return sets.size();
+    }
+
+    /*
+     * Return the ids of the Sets that share at least one band with S, in increasing order
+     * O(bands + number of candidates), plus O(n) if S does not maintain a sketch
+     */
+    std::vector<size_t> candidates(const set_type& S) const;
+
+    /*
+     * Return the ids of the candidates whose exact similarity to S is at least threshold
+     * Each candidate is verified in O(n)
+     */
+    std::vector<size_t> near_duplicates(const set_type& S, double threshold) const;
+
+private:
+    using Bucket = std::unordered_map<std::uint64_t, std::vector<size_t>>;
+
+    size_t rows;                      // values of the signature per band
+    std::vector<Bucket> buckets;      // for each band: key of the band -> ids of the Sets
+    std::vector<const set_type*> sets;
+
+    /*
+     * Return the key of band b of signature sig
+     */
+    std::uint64_t band_key(const MinHash::Signature& sig, size_t b) const;
+};
+
+/*
+ * An index of Sets of ints
+ */
+using SetIndex = BasicSetIndex<int>;
+
+/* *********************************************************** */
+/*            Member functions implementation                  */
+/* *********************************************************** */
+
+/*
+ * Constructor: create an empty index
+ */
+template <class T, class Compare, class Allocator>
+    requires is_equality_order_v<T, Compare>
+BasicSetIndex<T, Compare, Allocator>::BasicSetIndex(size_t bands) : rows{MinHash::n_bins / bands}, buckets(bands) {
+    assert(bands > 0 && MinHash::n_bins % bands == 0);
+}
+
+/*
+ * Add Set S to the index
+ */
+template <class T, class Compare, class Allocator>
+    requires is_equality_order_v<T, Compare>
+size_t BasicSetIndex<T, Compare, Allocator>::insert(const set_type& S) { // O(bands)
+    const size_t id = sets.size();
+    sets.push_back(&S);
+
+    const MinHash::Signature sig = S.sketch().signature();
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        buckets[b][band_key(sig, b)].push_back(id);
+    }
+    return id;
+}
+
+/*
+ * Return the ids of the Sets that share at least one band with S
+ */
+template <class T, class Compare, class Allocator>
+    requires is_equality_order_v<T, Compare>
+std::vector<size_t> BasicSetIndex<T, Compare, Allocator>::candidates(const set_type& S) const { // O(bands + k log k)
+    const MinHash::Signature sig = S.sketch().signature();
+
+    std::vector<size_t> ids;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        if (auto it = buckets[b].find(band_key(sig, b)); it != buckets[b].end()) {
+            ids.insert(ids.end(), it->second.begin(), it->second.end());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+/*
+ * Return the ids of the candidates whose exact similarity to S is at least threshold
+ */
+template <class T, class Compare, class Allocator>
+    requires is_equality_order_v<T, Compare>
+std::vector<size_t> BasicSetIndex<T, Compare, Allocator>::near_duplicates(const set_type& S,
+                                                                         double threshold) const { // O(k n)
+    std::vector<size_t> ids = candidates(S);
+    std::erase_if(ids, [&](size_t id) { return sets[id]->similarity(S) < threshold; });
+    return ids;
+}
+
+/*
+ * Return the key of band b of signature sig
+ */
+template <class T, class Compare, class Allocator>
+    requires is_equality_order_v<T, Compare>
+std::uint64_t BasicSetIndex<T, Compare, Allocator>::band_key(const MinHash::Signature& sig, size_t b) const {
+    std::uint64_t key = b;
+    for (size_t i = b * rows; i < (b + 1) * rows; ++i) {
+        key = mix64(key ^ sig[i]) + i;
+    }
+    return key;
+}
@@ -0,0 +1,517 @@
+#include "setview.h"
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char magic[4] = {'T', 'S', 'E', 'T'};
+
+/*
+ * Read a little endian unsigned int of n_bytes bytes starting at p
+ */
+std::uint64_t read_fixed(const std::byte* p, int n_bytes) {
+    std::uint64_t val = 0;
+    for (int i = 0; i < n_bytes; ++i) {
+        val |= std::to_integer<std::uint64_t>(p[i]) << (8 * i);
+    }
+    return val;
+}
+
+}  // namespace
+
+/*****************************************************
+ * SetEncoder                                         *
+ ******************************************************/
+
+/*
+ * Constructor: write the header of the format to os
+ */
+SetEncoder::SetEncoder(std::ostream& os)
+    : out{os}, offset{0}, n_values{0}, last_value{0}, finished{false} {
+    block.reserve(set_binary::block_size);
+    out.write(magic, sizeof(magic));
+    offset += sizeof(magic);
+    write_fixed(set_binary::version, 4);
+}
+
+/*
+ * Destructor: call finish, if not yet done
+ */
+SetEncoder::~SetEncoder() {
+    if (!finished) {
+        finish();
+    }
+}
+
+/*
+ * Add val to the output
+ * \param val must be larger than all values pushed before
+ */
+void SetEncoder::push(int val) { // O(1) amortized
+    assert(!finished);
+    assert(n_values == 0 || val > last_value);
+
+    block.push_back(val);
+    last_value = val;
+    ++n_values;
+    if (block.size() == set_binary::block_size) {
+        write_block();
+    }
+}
+
+/*
+ * Write the pending block, the block index, and the footer
+ * No values can be pushed afterwards
+ */
+void SetEncoder::finish() { // O(number of blocks)
+    assert(!finished);
+    write_block();
+    write_varint(0);  // end of the blocks
+
+    const std::uint64_t index_offset = offset;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        write_fixed(static_cast<std::uint32_t>(first_values[i]), 4);
+        write_fixed(offsets[i], 8);
+    }
+
+    write_fixed(n_values, 8);
+    write_fixed(offsets.size(), 8);
+    write_fixed(index_offset, 8);
+    out.write(magic, sizeof(magic));
+    offset += sizeof(magic);
+    finished = true;
+}
+
+void SetEncoder::write_block() {
+    if (block.empty()) {
+        return;
+    }
+
+    first_values.push_back(block.front());
+    offsets.push_back(offset);
+
+    write_varint(static_cast<std::uint32_t>(block.size()));
+    write_varint(set_binary::zigzag(block.front()));
+    for (size_t i = 1; i < block.size(); ++i) {
+        // values are unique, so the gap is at least one
+        write_varint(static_cast<std::uint32_t>(block[i]) - static_cast<std::uint32_t>(block[i - 1]) - 1);
+    }
+    block.clear();
+}
+
+void SetEncoder::write_varint(std::uint32_t val) {
+    char buffer[5];
+    int n = 0;
+    while (val >= 0x80) {
+        buffer[n++] = static_cast<char>((val & 0x7F) | 0x80);
+        val >>= 7;
+    }
+    buffer[n++] = static_cast<char>(val);
+    out.write(buffer, n);
+    offset += n;
+}
+
+void SetEncoder::write_fixed(std::uint64_t val, int n_bytes) {
+    char buffer[8];
+    for (int i = 0; i < n_bytes; ++i) {
+        buffer[i] = static_cast<char>((val >> (8 * i)) & 0xFF);
+    }
+    out.write(buffer, n_bytes);
+    offset += n_bytes;
+}
+
+/*****************************************************
+ * SetDecoder                                         *
+ ******************************************************/
+
+/*
+ * Constructor: read the header of the format from is
+ * The stream failbit is set if the header is not valid
+ */
+SetDecoder::SetDecoder(std::istream& is)
+    : in{is}, remaining{0}, previous{0}, n_blocks{0}, done{false} {
+    char header[set_binary::header_size];
+    if (!in.read(header, sizeof(header)) || !std::equal(magic, magic + 4, header) ||
+        read_fixed(reinterpret_cast<const std::byte*>(header + 4), 4) != set_binary::version) {
+        in.setstate(std::ios::failbit);
+        done = true;
+    }
+}
+
+/*
+ * Read the next value into val
+ * Return false if there are no more values or the input is not valid
+ * At the end, the block index and the footer are consumed from the stream
+ */
+bool SetDecoder::next(int& val) { // O(1)
+    if (done) {
+        return false;
+    }
+
+    std::uint32_t x;
+    if (remaining > 0) {
+        if (!read_varint(x)) {
+            return false;
+        }
+        previous = static_cast<int>(static_cast<std::uint32_t>(previous) + x + 1);
+        --remaining;
+        val = previous;
+        return true;
+    }
+
+    // start a new block
+    if (!read_varint(remaining)) {
+        return false;
+    }
+    if (remaining == 0) {
+        read_footer();
+        return false;
+    }
+    if (!read_varint(x)) {
+        return false;
+    }
+    ++n_blocks;
+    previous = set_binary::unzigzag(x);
+    --remaining;
+    val = previous;
+    return true;
+}
+
+/*
+ * Consume the block index and the footer, and check them against what was decoded
+ */
+void SetDecoder::read_footer() {
+    done = true;
+    in.ignore(static_cast<std::streamsize>(n_blocks * set_binary::index_entry_size));
+
+    char footer[set_binary::footer_size];
+    if (!in.read(footer, sizeof(footer))) {
+        return;
+    }
+
+    const auto* f = reinterpret_cast<const std::byte*>(footer);
+    if (read_fixed(f + 8, 8) != n_blocks || !std::equal(magic, magic + 4, footer + 24)) {
+        in.setstate(std::ios::failbit);
+    }
+}
+
+bool SetDecoder::read_varint(std::uint32_t& val) {
+    val = 0;
+    char c;
+    for (int shift = 0; shift < 35 && in.get(c); shift += 7) {
+        const auto b = static_cast<std::uint32_t>(static_cast<unsigned char>(c));
+        val |= (b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    in.setstate(std::ios::failbit);
+    done = true;
+    return false;
+}
+
+/*****************************************************
+ * SetView                                            *
+ ******************************************************/
+
+/*
+ * Constructor: view the Set encoded in bytes
+ * If bytes is not in the binary format then the view is empty and is_valid() is false
+ */
+SetView::SetView(std::span<const std::byte> bytes) : data{bytes} { // O(1)
+    const std::byte* first = bytes.data();
+    const size_t size = bytes.size();
+    const auto* m = reinterpret_cast<const std::byte*>(magic);
+
+    valid = size >= set_binary::header_size + 1 + set_binary::footer_size &&
+            std::equal(m, m + 4, first) && read_fixed(first + 4, 4) == set_binary::version &&
+            std::equal(m, m + 4, first + size - 4);
+    if (!valid) {
+        return;
+    }
+
+    const std::byte* footer = first + size - set_binary::footer_size;
+    const std::uint64_t n_values = read_fixed(footer, 8);
+    const std::uint64_t blocks_count = read_fixed(footer + 8, 8);
+    const std::uint64_t index_offset = read_fixed(footer + 16, 8);
+
+    valid = index_offset >= set_binary::header_size + 1 &&
+            index_offset + blocks_count * set_binary::index_entry_size == size - set_binary::footer_size &&
+            n_values <= blocks_count * set_binary::block_size;
+    if (!valid) {
+        return;
+    }
+
+    counter = static_cast<size_t>(n_values);
+    n_blocks = static_cast<size_t>(blocks_count);
+    blocks = first + set_binary::header_size;
+    index = first + index_offset;
+}
+
+/*
+ * Test whether val belongs to the Set
+ * Binary search in the block index, then decode one block -- O(log n + block_size)
+ */
+bool SetView::is_member(int val) const {
+    // find the last block whose first value is not larger than val
+    size_t lo = 0;
+    size_t hi = n_blocks;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (first_value(mid) <= val) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return false;
+    }
+
+    const std::byte* last = index;
+    const std::uint64_t offset = block_offset(lo - 1);
+    if (offset >= static_cast<std::uint64_t>(last - data.data())) {
+        return false;
+    }
+
+    // decode the block until val is passed
+    const_iterator it{data.data() + offset, last};
+    for (size_t i = 0; it != end() && i < set_binary::block_size; ++it, ++i) {
+        if (*it >= val) {
+            return *it == val;
+        }
+    }
+    return false;
+}
+
+SetView::const_iterator SetView::begin() const {
+    if (!valid) {
+        return end();
+    }
+    return const_iterator{blocks, index};
+}
+
+/*
+ * Three-way comparison operator: subset ordering, as for class Set
+ */
+std::partial_ordering SetView::operator<=>(const SetView& V) const { // O(n + m)
+    auto p1 = begin();
+    auto p2 = V.begin();
+    bool less_than = true;
+    bool greater_than = true;
+
+    while (p1 != end() && p2 != V.end()) {
+        if (*p1 < *p2) {
+            less_than = false;
+            ++p1;
+        } else if (*p1 > *p2) {
+            greater_than = false;
+            ++p2;
+        } else {
+            ++p1;
+            ++p2;
+        }
+    }
+
+    if (p1 != end()) {
+        less_than = false;
+    }
+    if (p2 != V.end()) {
+        greater_than = false;
+    }
+
+    if (less_than && greater_than) {
+        return std::partial_ordering::equivalent;
+    } else if (less_than) {
+        return std::partial_ordering::less;
+    } else if (greater_than) {
+        return std::partial_ordering::greater;
+    }
+    return std::partial_ordering::unordered;
+}
+
+bool SetView::operator==(const SetView& V) const { // O(n + m)
+    return cardinality() == V.cardinality() && (*this <=> V) == std::partial_ordering::equivalent;
+}
+
+int SetView::first_value(size_t block) const {
+    return static_cast<int>(static_cast<std::uint32_t>(read_fixed(index + block * set_binary::index_entry_size, 4)));
+}
+
+std::uint64_t SetView::block_offset(size_t block) const {
+    return read_fixed(index + block * set_binary::index_entry_size + 4, 8);
+}
+
+SetView::const_iterator::const_iterator(const std::byte* p, const std::byte* end_of_blocks)
+    : pos{p}, last{end_of_blocks} {
+    start_block();
+}
+
+SetView::const_iterator& SetView::const_iterator::operator++() {
+    if (remaining == 0) {
+        start_block();
+        return *this;
+    }
+
+    std::uint32_t gap;
+    pos = set_binary::read_varint(pos, last, gap);
+    if (pos == nullptr) {  // truncated input: stop the iteration
+        remaining = 0;
+        return *this;
+    }
+    value = static_cast<int>(static_cast<std::uint32_t>(value) + gap + 1);
+    --remaining;
+    return *this;
+}
+
+void SetView::const_iterator::start_block() {
+    std::uint32_t n = 0;
+    pos = set_binary::read_varint(pos, last, n);
+
+    std::uint32_t first = 0;
+    if (pos == nullptr || n == 0 || (pos = set_binary::read_varint(pos, last, first)) == nullptr) {
+        pos = nullptr;  // end of the blocks
+        remaining = 0;
+        return;
+    }
+    value = set_binary::unzigzag(first);
+    remaining = n - 1;
+}
+
+/*****************************************************
+ * Merging two views                                  *
+ ******************************************************/
+
+void set_union(const SetView& A, const SetView& B, SetEncoder& out) { // O(n + m)
+    auto p1 = A.begin();
+    auto p2 = B.begin();
+
+    while (p1 != A.end() && p2 != B.end()) {
+        if (*p1 < *p2) {
+            out.push(*p1++);
+        } else if (*p1 > *p2) {
+            out.push(*p2++);
+        } else {
+            out.push(*p1++);
+            ++p2;
+        }
+    }
+    for (; p1 != A.end(); ++p1) {
+        out.push(*p1);
+    }
+    for (; p2 != B.end(); ++p2) {
+        out.push(*p2);
+    }
+}
+
+void set_intersection(const SetView& A, const SetView& B, SetEncoder& out) { // O(n + m)
+    auto p1 = A.begin();
+    auto p2 = B.begin();
+
+    while (p1 != A.end() && p2 != B.end()) {
+        if (*p1 < *p2) {
+            ++p1;
+        } else if (*p1 > *p2) {
+            ++p2;
+        } else {
+            out.push(*p1++);
+            ++p2;
+        }
+    }
+}
+
+void set_difference(const SetView& A, const SetView& B, SetEncoder& out) { // O(n + m)
+    auto p1 = A.begin();
+    auto p2 = B.begin();
+
+    while (p1 != A.end() && p2 != B.end()) {
+        if (*p1 < *p2) {
+            out.push(*p1++);
+        } else if (*p1 > *p2) {
+            ++p2;
+        } else {
+            ++p1;
+            ++p2;
+        }
+    }
+    for (; p1 != A.end(); ++p1) {
+        out.push(*p1);
+    }
+}
+
+/*****************************************************
+ * MappedFile                                         *
+ ******************************************************/
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& file) {
+    HANDLE h = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(h, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            length = static_cast<size_t>(size.QuadPart);
+        }
+    }
+    CloseHandle(h);
+
+    if (addr == nullptr) {
+        length = 0;
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (addr != nullptr) {
+        UnmapViewOfFile(addr);
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& file) {
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            addr = p;
+            length = static_cast<size_t>(st.st_size);
+        }
+    }
+    ::close(fd);  // the mapping stays valid after closing the file
+}
+
+MappedFile::~MappedFile() {
+    if (addr != nullptr) {
+        ::munmap(addr, length);
+    }
+}
+
+#endif
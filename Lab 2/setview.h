@@ -0,0 +1,289 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <compare>  // three-way comparison operator <=>
+#include <filesystem>
+
+/** Binary format of a Set
+ *
+ * The values are stored increasingly sorted, in blocks of at most block_size values
+ *   header:  magic "TSET", format version (u32)
+ *   blocks:  number of values n (varint), first value (zigzag varint),
+ *            n-1 gaps to the previous value minus one (varint)
+ *   end:     a block with n == 0
+ *   index:   for each block, its first value (i32) and its byte offset (u64)
+ *   footer:  number of values (u64), number of blocks (u64), byte offset of the index (u64),
+ *            magic "TSET"
+ *
+ * Fixed width fields are little endian, varints use 7 bits per byte (LEB128)
+ * The index lets a SetView find the block of a value with a binary search
+ */
+namespace set_binary {
+
+constexpr std::uint32_t version = 1;
+constexpr std::size_t block_size = 128;
+constexpr std::size_t header_size = 8;
+constexpr std::size_t index_entry_size = 12;
+constexpr std::size_t footer_size = 28;
+
+/*
+ * Decode the varint starting at p into val
+ * Return a pointer to the byte following the varint, or nullptr if it does not end before last
+ */
+inline const std::byte* read_varint(const std::byte* p, const std::byte* last, std::uint32_t& val) {
+    val = 0;
+    for (int shift = 0; p != last && shift < 35; shift += 7) {
+        const auto b = std::to_integer<std::uint32_t>(*p++);
+        val |= (b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+/*
+ * Map an int to an unsigned int such that values close to zero get short varints
+ */
+constexpr std::uint32_t zigzag(int val) {
+    return (static_cast<std::uint32_t>(val) << 1) ^ static_cast<std::uint32_t>(val >> 31);
+}
+
+constexpr int unzigzag(std::uint32_t val) {
+    return static_cast<int>((val >> 1) ^ (~(val & 1) + 1));
+}
+
+}  // namespace set_binary
+
+/** Class SetEncoder
+ *
+ * Write an increasingly sorted sequence of unique ints to a stream, in the binary format
+ * Values are added one at a time with push and the output is completed by finish
+ */
+class SetEncoder {
+public:
+    /*
+     * Constructor: write the header of the format to os
+     */
+    explicit SetEncoder(std::ostream& os);
+
+    /*
+     * Destructor: call finish, if not yet done
+     */
+    ~SetEncoder();
+
+    SetEncoder(const SetEncoder&) = delete;
+    SetEncoder& operator=(const SetEncoder&) = delete;
+
+    /*
+     * Add val to the output
+     * \param val must be larger than all values pushed before
+     */
+    void push(int val);
+
+    /*
+     * Write the pending block, the block index, and the footer
+     * No values can be pushed afterwards
+     */
+    void finish();
+
+private:
+    std::ostream& out;
+    std::uint64_t offset;               // number of bytes written so far
+    std::uint64_t n_values;             // number of values pushed so far
+    int last_value;                     // last value pushed
+    std::vector<int> block;             // values of the block being filled
+    std::vector<int> first_values;      // first value of each written block
+    std::vector<std::uint64_t> offsets; // byte offset of each written block
+    bool finished;
+
+    void write_block();
+    void write_varint(std::uint32_t val);
+    void write_fixed(std::uint64_t val, int n_bytes);
+};
+
+/** Class SetDecoder
+ *
+ * Read the values of a Set in the binary format from a stream, one at a time
+ */
+class SetDecoder {
+public:
+    /*
+     * Constructor: read the header of the format from is
+     * The stream failbit is set if the header is not valid
+     */
+    explicit SetDecoder(std::istream& is);
+
+    /*
+     * Read the next value into val
+     * Return false if there are no more values or the input is not valid
+     * At the end, the block index and the footer are consumed from the stream
+     */
+    bool next(int& val);
+
+private:
+    std::istream& in;
+    std::uint32_t remaining;  // values left in the current block
+    int previous;             // last value read
+    std::uint64_t n_blocks;   // number of blocks started so far
+    bool done;
+
+    bool read_varint(std::uint32_t& val);
+    void read_footer();
+};
+
+/** Class SetView
+ *
+ * Read-only view of a Set stored in the binary format, e.g. in a memory-mapped file
+ * No Nodes are created: queries decode the bytes directly
+ * The bytes must outlive the view
+ */
+class SetView {
+public:
+    /*
+     * Forward iterator that decodes the values in increasing order
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator() = default;
+
+        reference operator*() const {
+            return value;
+        }
+
+        const_iterator& operator++();
+
+        const_iterator operator++(int) {
+            const_iterator tmp{*this};
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& it) const {
+            return pos == it.pos && remaining == it.remaining;
+        }
+
+    private:
+        friend class SetView;
+
+        const_iterator(const std::byte* p, const std::byte* last);
+
+        const std::byte* pos = nullptr;   // next byte to decode, nullptr at the end
+        const std::byte* last = nullptr;  // end of the encoded blocks
+        std::uint32_t remaining = 0;      // values left in the current block after value
+        int value = 0;
+
+        void start_block();
+    };
+
+    /*
+     * Constructor: an empty view
+     */
+    SetView() = default;
+
+    /*
+     * Constructor: view the Set encoded in bytes
+     * If bytes is not in the binary format then the view is empty and is_valid() is false
+     */
+    explicit SetView(std::span<const std::byte> bytes);
+
+    /*
+     * Return true if the bytes given to the constructor are in the binary format
+     */
+    bool is_valid() const {
+        return valid;
+    }
+
+    bool is_empty() const {
+        return counter == 0;
+    }
+
+    size_t cardinality() const {
+        return counter;
+    }
+
+    /*
+     * Test whether val belongs to the Set
+     * Binary search in the block index, then decode one block -- O(log n + block_size)
+     */
+    bool is_member(int val) const;
+
+    const_iterator begin() const;
+
+    const_iterator end() const {
+        return const_iterator{};
+    }
+
+    /*
+     * Three-way comparison operator: subset ordering, as for class Set
+     */
+    std::partial_ordering operator<=>(const SetView& V) const;
+
+    bool operator==(const SetView& V) const;
+
+private:
+    std::span<const std::byte> data;   // the whole encoded Set
+    const std::byte* blocks = nullptr; // first block
+    const std::byte* index = nullptr;  // block index
+    size_t counter = 0;                // number of values
+    size_t n_blocks = 0;
+    bool valid = true;
+
+    int first_value(size_t block) const;
+    std::uint64_t block_offset(size_t block) const;
+};
+
+/*
+ * Write the union, intersection, or difference of A and B to out
+ * Both views are merged in one pass, no Nodes are created
+ */
+void set_union(const SetView& A, const SetView& B, SetEncoder& out);
+void set_intersection(const SetView& A, const SetView& B, SetEncoder& out);
+void set_difference(const SetView& A, const SetView& B, SetEncoder& out);
+
+/** Class MappedFile
+ *
+ * A file mapped read-only into memory
+ * Usage: MappedFile f{"sets.bin"}; SetView V{f.bytes()};
+ */
+class MappedFile {
+public:
+    /*
+     * Constructor: map the file into memory
+     * If the file cannot be mapped then is_open() is false and bytes() is empty
+     */
+    explicit MappedFile(const std::filesystem::path& file);
+
+    /*
+     * Destructor: unmap the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const {
+        return addr != nullptr;
+    }
+
+    std::span<const std::byte> bytes() const {
+        return {static_cast<const std::byte*>(addr), length};
+    }
+
+private:
+    void* addr = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;  // HANDLE of the file mapping
+#endif
+};
@@ -0,0 +1,859 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <cassert>
+#include <compare>  // three-way comparison operator <=>
+
+/** Class to represent a Set of values of type T, as an unrolled linked list
+ *
+ * Same interface as class BasicSet (set.h), but each Block of the doubly linked list stores
+ * a sorted array of up to Capacity values, instead of a single value
+ *   - insert splits a full Block in two halves (overflow)
+ *   - erase merges a Block with a neighbour when it gets less than 1/4 full (underflow)
+ *   - the merge operations +=, *=, -= work block by block: a Block whose values all lie
+ *     before the next value of the other Set is spliced, copied, or dropped as a whole
+ *
+ * Compared to BasicSet, there are about Capacity times fewer Nodes to allocate and follow
+ * The values are sorted by Compare and there are no repetitions
+ *
+ * All Set operations have a linear time complexity, in the worst case
+ */
+template <class T, class Compare = std::less<T>, std::size_t Capacity = 32>
+class BasicUnrolledSet {
+    static_assert(Capacity >= 16 && Capacity <= 64, "Blocks should hold 16 to 64 values");
+
+    struct Block;
+
+public:
+    using value_type = T;
+    using value_compare = Compare;
+
+    /*
+     * Forward iterator to visit the values of a Set in increasing order
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : blk{nullptr}, i{0} {}
+
+        reference operator*() const {
+            return blk->values[i];
+        }
+
+        const_iterator& operator++() {
+            if (++i == blk->size) {
+                blk = blk->next;
+                i = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp{*this};
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& it) const = default;
+
+    private:
+        friend class BasicUnrolledSet;
+
+        const_iterator(const Block* b, std::size_t idx) : blk{b}, i{idx} {}
+
+        const Block* blk;
+        std::size_t i;
+    };
+
+    /*
+     * Tag type to select the constructor that accepts unsorted input
+     */
+    struct unsorted_t {
+        explicit unsorted_t() = default;
+    };
+    static constexpr unsorted_t unsorted{};
+
+    /*
+     *  Default constructor :create an empty Set
+     */
+    BasicUnrolledSet();
+
+    /*
+     *  Conversion constructor: convert val into a singleton {val}
+     */
+    BasicUnrolledSet(const T& val);
+
+    /*
+     * Constructor to create a Set from a sorted vector of unique values
+     * The Blocks are filled to Capacity
+     * \param list_of_values is an increasingly sorted vector of unique values
+     */
+    explicit BasicUnrolledSet(const std::vector<T>& list_of_values);
+
+    /*
+     * Constructor to create a Set from a vector of values in any order
+     * \param list_of_values vector of values, possibly unsorted and with repetitions
+     */
+    BasicUnrolledSet(std::vector<T> list_of_values, unsorted_t);
+
+    /*
+     * Copy constructor: create a new Set as a copy of Set S
+     */
+    BasicUnrolledSet(const BasicUnrolledSet& S);
+
+    /*
+     * Destructor: deallocate all Blocks
+     */
+    ~BasicUnrolledSet();
+
+    /*
+     * Assignment operator -- copy-and-swap idiom
+     */
+    BasicUnrolledSet& operator=(BasicUnrolledSet S);
+
+    /*
+     * Transform the Set into an empty set
+     */
+    void make_empty();
+
+    /*
+     * Test whether val belongs to the Set
+     * Blocks are skipped by their largest value, then val is searched in one Block
+     */
+    bool is_member(const T& val) const;
+
+    /*
+     * Insert val into the Set
+     * Return true if val was inserted, false if it already belonged to the Set
+     */
+    bool insert(const T& val);
+
+    /*
+     * Remove val from the Set
+     * Return true if val was removed, false if it did not belong to the Set
+     */
+    bool erase(const T& val);
+
+    bool is_empty() const {
+        return (counter == 0);
+    }
+
+    size_t cardinality() const {
+        return counter;
+    }
+
+    const_iterator begin() const {
+        return const_iterator{head->next, 0};
+    }
+
+    const_iterator end() const {
+        return const_iterator{tail, 0};
+    }
+
+    /*
+     * Three-way comparison operator: subset ordering, as for class BasicSet
+     */
+    std::partial_ordering operator<=>(const BasicUnrolledSet& S) const;
+
+    bool operator==(const BasicUnrolledSet& S) const;
+
+    /*
+     * Modify Set *this such that it becomes the union of *this with Set S
+     */
+    BasicUnrolledSet& operator+=(const BasicUnrolledSet& S);
+
+    /*
+     * Modify Set *this such that it becomes the intersection of *this with Set S
+     */
+    BasicUnrolledSet& operator*=(const BasicUnrolledSet& S);
+
+    /*
+     * Modify Set *this such that it becomes the Set difference between Set *this and Set S
+     */
+    BasicUnrolledSet& operator-=(const BasicUnrolledSet& S);
+
+    /*
+     * Return number of existing Blocks, of all Sets with the same template arguments
+     * Used solely for debug purposes
+     */
+    static int get_count_blocks() {
+        return count_blocks;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BasicUnrolledSet& S) {
+        S.write_to_stream(os);
+        return os;
+    }
+
+    friend BasicUnrolledSet operator+(BasicUnrolledSet S1, const BasicUnrolledSet& S2) {
+        return (S1 += S2);
+    }
+
+    friend BasicUnrolledSet operator*(BasicUnrolledSet S1, const BasicUnrolledSet& S2) {
+        return (S1 *= S2);
+    }
+
+    friend BasicUnrolledSet operator-(BasicUnrolledSet S1, const BasicUnrolledSet& S2) {
+        return (S1 -= S2);
+    }
+
+private:
+    /*
+     * A Block of the unrolled linked list: values[0..size) is sorted
+     * head and tail are dummy Blocks with size == 0
+     */
+    struct Block {
+        T values[Capacity];
+        std::size_t size = 0;
+        Block* next = nullptr;
+        Block* prev = nullptr;
+
+        const T& back() const {
+            return values[size - 1];
+        }
+    };
+
+    Block* head;     // pointer to the dummy header Block
+    Block* tail;     // pointer to the dummy tail Block
+    size_t counter;  // number of values in the Set
+    Block* spare;    // Blocks kept for reuse, linked through next
+
+    [[no_unique_address]] Compare comp;
+
+    inline static int count_blocks = 0;  // number of existing Blocks -- to help to detect bugs
+
+    // a Block with fewer values is merged with a neighbour
+    static constexpr std::size_t min_fill = Capacity / 4;
+
+    /*
+     * Return an empty Block, reusing a spare Block when possible
+     */
+    Block* get_block();
+
+    /*
+     * Keep Block b for reuse
+     */
+    void put_block(Block* b);
+
+    /*
+     * Insert Block b before Block p
+     */
+    static void link_before(Block* p, Block* b);
+
+    /*
+     * Remove Block b from the list, without deallocating it
+     */
+    static void unlink(Block* b);
+
+    /*
+     * Return the first Block whose largest value is not smaller than val, or tail
+     */
+    Block* find_block(const T& val) const;
+
+    /*
+     * Return the position of the first value in Block b not smaller than val
+     */
+    std::size_t lower_bound(const Block* b, const T& val) const;
+
+    /*
+     * Append val, or the values [first, last), at the end of the list
+     * The last Block is filled before a new Block is created
+     */
+    void append(const T& val);
+    void append(const T* first, const T* last);
+
+    /*
+     * Append all values of Block b at the end of the list
+     * b is spliced into the list in O(1), unless its values fit in the last Block
+     */
+    void append_block(Block* b);
+
+    /*
+     * Remove the values after position idx of Block w, and all Blocks after w
+     * Used to end the in-place compaction of *= and -=
+     */
+    void truncate(Block* w, std::size_t idx, size_t n_values);
+
+    /*
+     * Merge Block b with a neighbour, if b is less than min_fill full
+     */
+    void fix_underflow(Block* b);
+
+    void write_to_stream(std::ostream& os) const;
+};
+
+/*
+ * An unrolled Set of ints
+ */
+using UnrolledSet = BasicUnrolledSet<int>;
+
+/* *********************** Member functions implementation *********************** */
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>::BasicUnrolledSet()
+    : head{new Block{}}, tail{new Block{}}, counter{0}, spare{nullptr}, comp{} { // O(1)
+    count_blocks += 2;
+    head->next = tail;
+    tail->prev = head;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>::BasicUnrolledSet(const T& val) : BasicUnrolledSet{} { // O(1)
+    append(val);
+}
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>::BasicUnrolledSet(const std::vector<T>& list_of_values)
+    : BasicUnrolledSet{} { // O(n)
+    append(list_of_values.data(), list_of_values.data() + list_of_values.size());
+}
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>::BasicUnrolledSet(std::vector<T> list_of_values, unsorted_t)
+    : BasicUnrolledSet{} { // O(n log n)
+    std::sort(list_of_values.begin(), list_of_values.end(), comp);
+    auto last = std::unique(list_of_values.begin(), list_of_values.end(),
+                            [this](const T& a, const T& b) { return !comp(a, b) && !comp(b, a); });
+    append(list_of_values.data(), list_of_values.data() + (last - list_of_values.begin()));
+}
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>::BasicUnrolledSet(const BasicUnrolledSet& S)
+    : BasicUnrolledSet{} { // O(n)
+    comp = S.comp;
+    for (const Block* b = S.head->next; b != S.tail; b = b->next) {
+        append(b->values, b->values + b->size);
+    }
+}
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>::~BasicUnrolledSet() { // O(n / Capacity)
+    make_empty();
+    while (spare != nullptr) {
+        Block* b = spare;
+        spare = spare->next;
+        delete b;
+        --count_blocks;
+    }
+    delete head;
+    delete tail;
+    count_blocks -= 2;
+    assert(count_blocks >= 0);
+}
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>& BasicUnrolledSet<T, Compare, Capacity>::operator=(BasicUnrolledSet S) { // O(1)
+    std::swap(head, S.head);
+    std::swap(tail, S.tail);
+    std::swap(counter, S.counter);
+    std::swap(spare, S.spare);
+    std::swap(comp, S.comp);
+    return *this;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::make_empty() { // O(n / Capacity)
+    Block* b = head->next;
+    while (b != tail) {
+        Block* next = b->next;
+        put_block(b);
+        b = next;
+    }
+    head->next = tail;
+    tail->prev = head;
+    counter = 0;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+bool BasicUnrolledSet<T, Compare, Capacity>::is_member(const T& val) const { // O(n / Capacity + log Capacity)
+    const Block* b = find_block(val);
+    if (b == tail) {
+        return false;
+    }
+    const std::size_t i = lower_bound(b, val);
+    return !comp(val, b->values[i]);
+}
+
+template <class T, class Compare, std::size_t Capacity>
+bool BasicUnrolledSet<T, Compare, Capacity>::insert(const T& val) { // O(n / Capacity + Capacity)
+    Block* b = find_block(val);
+    if (b == tail) {  // val is larger than all values
+        append(val);
+        return true;
+    }
+
+    std::size_t i = lower_bound(b, val);
+    if (!comp(val, b->values[i])) {
+        return false;  // already in the Set
+    }
+
+    if (b->size == Capacity) {  // overflow: move the upper half to a new Block
+        Block* nb = get_block();
+        link_before(b->next, nb);
+        constexpr std::size_t half = Capacity / 2;
+        std::move(b->values + half, b->values + Capacity, nb->values);
+        nb->size = Capacity - half;
+        b->size = half;
+        if (i > half) {
+            b = nb;
+            i -= half;
+        }
+    }
+
+    std::move_backward(b->values + i, b->values + b->size, b->values + b->size + 1);
+    b->values[i] = val;
+    ++b->size;
+    ++counter;
+    return true;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+bool BasicUnrolledSet<T, Compare, Capacity>::erase(const T& val) { // O(n / Capacity + Capacity)
+    Block* b = find_block(val);
+    if (b == tail) {
+        return false;
+    }
+
+    const std::size_t i = lower_bound(b, val);
+    if (comp(val, b->values[i])) {
+        return false;  // not in the Set
+    }
+
+    std::move(b->values + i + 1, b->values + b->size, b->values + i);
+    --b->size;
+    --counter;
+    fix_underflow(b);
+    return true;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+std::partial_ordering BasicUnrolledSet<T, Compare, Capacity>::operator<=>(const BasicUnrolledSet& S) const { // O(n + m)
+    const Block* a = head->next;
+    const Block* b = S.head->next;
+    std::size_t i = 0;
+    std::size_t j = 0;
+    bool less_than = true;
+    bool greater_than = true;
+
+    while (a != tail && b != S.tail) {
+        while (i < a->size && j < b->size) {
+            if (comp(a->values[i], b->values[j])) {
+                less_than = false;
+                ++i;
+            } else if (comp(b->values[j], a->values[i])) {
+                greater_than = false;
+                ++j;
+            } else {
+                ++i;
+                ++j;
+            }
+        }
+        if (i == a->size) {
+            a = a->next;
+            i = 0;
+        }
+        if (j == b->size) {
+            b = b->next;
+            j = 0;
+        }
+    }
+
+    if (a != tail) {
+        less_than = false;
+    }
+    if (b != S.tail) {
+        greater_than = false;
+    }
+
+    if (less_than && greater_than) {
+        return std::partial_ordering::equivalent;
+    } else if (less_than) {
+        return std::partial_ordering::less;
+    } else if (greater_than) {
+        return std::partial_ordering::greater;
+    }
+    return std::partial_ordering::unordered;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+bool BasicUnrolledSet<T, Compare, Capacity>::operator==(const BasicUnrolledSet& S) const { // O(n + m)
+    return counter == S.counter && (*this <=> S) == std::partial_ordering::equivalent;
+}
+
+/*
+ * The Blocks of *this are detached and the union is appended to the empty list
+ * Blocks of *this that lie before the next value of S are spliced back unchanged
+ */
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>& BasicUnrolledSet<T, Compare, Capacity>::operator+=(const BasicUnrolledSet& S) { // O(n + m)
+    if (&S == this) {
+        return *this;
+    }
+
+    Block* a = head->next;  // detached list of *this, it still ends at tail
+    head->next = tail;
+    tail->prev = head;
+    counter = 0;
+
+    const Block* b = S.head->next;
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    while (a != tail && b != S.tail) {
+        if (i == 0 && comp(a->back(), b->values[j])) {  // whole Block a before S: splice
+            Block* next = a->next;
+            append_block(a);
+            a = next;
+            continue;
+        }
+        if (comp(b->back(), a->values[i])) {  // rest of Block b before *this: copy
+            append(b->values + j, b->values + b->size);
+            b = b->next;
+            j = 0;
+            continue;
+        }
+
+        while (i < a->size && j < b->size) {
+            if (comp(a->values[i], b->values[j])) {
+                append(a->values[i++]);
+            } else if (comp(b->values[j], a->values[i])) {
+                append(b->values[j++]);
+            } else {
+                append(a->values[i++]);
+                ++j;
+            }
+        }
+        if (i == a->size) {
+            Block* next = a->next;
+            put_block(a);
+            a = next;
+            i = 0;
+        }
+        if (j == b->size) {
+            b = b->next;
+            j = 0;
+        }
+    }
+
+    while (a != tail) {
+        Block* next = a->next;
+        if (i == 0) {
+            append_block(a);
+        } else {
+            append(a->values + i, a->values + a->size);
+            put_block(a);
+            i = 0;
+        }
+        a = next;
+    }
+    for (; b != S.tail; b = b->next, j = 0) {
+        append(b->values + j, b->values + b->size);
+    }
+    return *this;
+}
+
+/*
+ * In-place compaction: the kept values are written back at a position (w, wi) that never
+ * passes the read position (a, i), then the Blocks after w are released
+ */
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>& BasicUnrolledSet<T, Compare, Capacity>::operator*=(const BasicUnrolledSet& S) { // O(n + m)
+    if (&S == this) {
+        return *this;
+    }
+
+    Block* w = head->next;
+    std::size_t wi = 0;
+    size_t kept = 0;
+    auto write = [&](const T& val) {
+        if (wi == Capacity) {
+            w->size = Capacity;
+            w = w->next;
+            wi = 0;
+        }
+        w->values[wi++] = val;
+        ++kept;
+    };
+
+    Block* a = head->next;
+    const Block* b = S.head->next;
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    while (a != tail && b != S.tail) {
+        if (comp(b->back(), a->values[i])) {  // rest of Block b before *this: skip it
+            b = b->next;
+            j = 0;
+            continue;
+        }
+        if (comp(a->back(), b->values[j])) {  // rest of Block a not in S: drop it
+            a = a->next;
+            i = 0;
+            continue;
+        }
+
+        while (i < a->size && j < b->size) {
+            if (comp(a->values[i], b->values[j])) {
+                ++i;
+            } else if (comp(b->values[j], a->values[i])) {
+                ++j;
+            } else {
+                write(a->values[i++]);
+                ++j;
+            }
+        }
+        if (i == a->size) {
+            a = a->next;
+            i = 0;
+        }
+        if (j == b->size) {
+            b = b->next;
+            j = 0;
+        }
+    }
+
+    truncate(w, wi, kept);
+    return *this;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+BasicUnrolledSet<T, Compare, Capacity>& BasicUnrolledSet<T, Compare, Capacity>::operator-=(const BasicUnrolledSet& S) { // O(n + m)
+    if (&S == this) {
+        make_empty();
+        return *this;
+    }
+
+    Block* w = head->next;
+    std::size_t wi = 0;
+    size_t kept = 0;
+    auto write = [&](const T& val) {
+        if (wi == Capacity) {
+            w->size = Capacity;
+            w = w->next;
+            wi = 0;
+        }
+        w->values[wi++] = val;
+        ++kept;
+    };
+
+    Block* a = head->next;
+    const Block* b = S.head->next;
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    while (a != tail && b != S.tail) {
+        if (comp(b->back(), a->values[i])) {  // rest of Block b before *this: skip it
+            b = b->next;
+            j = 0;
+            continue;
+        }
+        if (comp(a->back(), b->values[j])) {  // rest of Block a not in S: keep it
+            if (w == a && wi == i) {  // nothing removed from this Block yet: no copy
+                wi = a->size;
+                kept += a->size - i;
+            } else {
+                for (; i < a->size; ++i) {
+                    write(a->values[i]);
+                }
+            }
+            a = a->next;
+            i = 0;
+            continue;
+        }
+
+        while (i < a->size && j < b->size) {
+            if (comp(a->values[i], b->values[j])) {
+                write(a->values[i++]);
+            } else if (comp(b->values[j], a->values[i])) {
+                ++j;
+            } else {
+                ++i;
+                ++j;
+            }
+        }
+        if (i == a->size) {
+            a = a->next;
+            i = 0;
+        }
+        if (j == b->size) {
+            b = b->next;
+            j = 0;
+        }
+    }
+
+    // values of *this after the last value of S are kept
+    for (; a != tail; a = a->next, i = 0) {
+        if (w == a && wi == i) {
+            wi = a->size;
+            kept += a->size - i;
+        } else {
+            for (; i < a->size; ++i) {
+                write(a->values[i]);
+            }
+        }
+    }
+
+    truncate(w, wi, kept);
+    return *this;
+}
+
+/* ******************* Private member functions ********************* */
+
+template <class T, class Compare, std::size_t Capacity>
+typename BasicUnrolledSet<T, Compare, Capacity>::Block* BasicUnrolledSet<T, Compare, Capacity>::get_block() { // O(1)
+    Block* b = spare;
+    if (b != nullptr) {
+        spare = spare->next;
+    } else {
+        b = new Block{};
+        ++count_blocks;
+    }
+    b->size = 0;
+    b->next = b->prev = nullptr;
+    return b;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::put_block(Block* b) { // O(1)
+    b->next = spare;
+    spare = b;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::link_before(Block* p, Block* b) { // O(1)
+    b->next = p;
+    b->prev = p->prev;
+    p->prev->next = b;
+    p->prev = b;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::unlink(Block* b) { // O(1)
+    b->prev->next = b->next;
+    b->next->prev = b->prev;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+typename BasicUnrolledSet<T, Compare, Capacity>::Block*
+BasicUnrolledSet<T, Compare, Capacity>::find_block(const T& val) const { // O(n / Capacity)
+    Block* b = head->next;
+    while (b != tail && comp(b->back(), val)) {
+        b = b->next;
+    }
+    return b;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+std::size_t BasicUnrolledSet<T, Compare, Capacity>::lower_bound(const Block* b, const T& val) const { // O(log Capacity)
+    return static_cast<std::size_t>(std::lower_bound(b->values, b->values + b->size, val, comp) - b->values);
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::append(const T& val) { // O(1)
+    Block* last = tail->prev;
+    if (last == head || last->size == Capacity) {
+        last = get_block();
+        link_before(tail, last);
+    }
+    last->values[last->size++] = val;
+    ++counter;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::append(const T* first, const T* last) { // O(last - first)
+    while (first != last) {
+        Block* b = tail->prev;
+        if (b == head || b->size == Capacity) {
+            b = get_block();
+            link_before(tail, b);
+        }
+        const std::size_t n = std::min<std::size_t>(Capacity - b->size, static_cast<std::size_t>(last - first));
+        std::copy(first, first + n, b->values + b->size);
+        b->size += n;
+        counter += n;
+        first += n;
+    }
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::append_block(Block* b) { // O(1), or O(Capacity) to merge
+    Block* last = tail->prev;
+    if (last != head && last->size + b->size <= Capacity) {
+        std::copy(b->values, b->values + b->size, last->values + last->size);
+        last->size += b->size;
+        counter += b->size;
+        put_block(b);
+    } else {
+        link_before(tail, b);
+        counter += b->size;
+    }
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::truncate(Block* w, std::size_t idx, size_t n_values) { // O(n / Capacity)
+    Block* b = w;
+    if (w != tail) {
+        w->size = idx;
+        if (idx > 0) {
+            b = w->next;
+        }
+    }
+
+    while (b != tail) {
+        Block* next = b->next;
+        unlink(b);
+        put_block(b);
+        b = next;
+    }
+    counter = n_values;
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::fix_underflow(Block* b) { // O(Capacity)
+    if (b->size >= min_fill) {
+        return;
+    }
+
+    if (b->size == 0) {
+        unlink(b);
+        put_block(b);
+        return;
+    }
+
+    // merge b into its previous Block, or the next Block into b, if the values fit
+    if (b->prev != head && b->prev->size + b->size <= Capacity) {
+        Block* p = b->prev;
+        std::copy(b->values, b->values + b->size, p->values + p->size);
+        p->size += b->size;
+        unlink(b);
+        put_block(b);
+    } else if (b->next != tail && b->next->size + b->size <= Capacity) {
+        Block* n = b->next;
+        std::copy(n->values, n->values + n->size, b->values + b->size);
+        b->size += n->size;
+        unlink(n);
+        put_block(n);
+    }
+}
+
+template <class T, class Compare, std::size_t Capacity>
+void BasicUnrolledSet<T, Compare, Capacity>::write_to_stream(std::ostream& os) const { // O(n)
+    if (is_empty()) {
+        os << "Set is empty!";
+    } else {
+        os << "{ ";
+        for (const T& val : *this) {
+            os << val << " ";
+        }
+        os << "}";
+    }
+}
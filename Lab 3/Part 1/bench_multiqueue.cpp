@@ -0,0 +1,168 @@
+/*
+ * Throughput scaling and rank error of MultiQueue, against a PriorityQueue behind one lock
+ *
+ * Usage: bench_multiqueue [--max-threads N] [--size N] [--ops N]
+ *   --max-threads  largest number of threads, 1, 2, 4, ..., up to N (default 64)
+ *   --size         number of elements in the queue (default 2^20)
+ *   --ops          hold operations, i.e. deleteMin followed by insert, shared by the threads (default 2^22)
+ *
+ * Reported:
+ *   throughput:  million hold operations per second of all threads, for the locked PriorityQueue and for
+ *                a MultiQueue of 2 * T PriorityQueues (c = 2)
+ *   rank error:  rank of the deleted element among the elements of the queue, 0 for the smallest,
+ *                mean and maximum over n / 2 deleteMin by one thread, for 1 to 256 queues
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <cstddef>
+
+#include <particlesystem/priorityqueue.h>
+#include <particlesystem/multiqueue.h>
+
+#include <fmt/format.h>
+
+namespace {
+
+struct Config {
+    int maxThreads = 64;
+    std::size_t size = std::size_t{1} << 20;
+    std::size_t ops = std::size_t{1} << 22;
+};
+
+/**
+ * A PriorityQueue behind one lock, the baseline
+ */
+class LockedPriorityQueue {
+public:
+    explicit LockedPriorityQueue(int) {}
+
+    void insert(double x) {
+        std::lock_guard lock{mutex};
+        queue.insert(x);
+    }
+
+    std::optional<double> tryDeleteMin() {
+        std::lock_guard lock{mutex};
+        if (queue.isEmpty()) {
+            return std::nullopt;
+        }
+        return queue.deleteMin();
+    }
+
+private:
+    std::mutex mutex;
+    PriorityQueue<double> queue;
+};
+
+/**
+ * Million hold operations per second of nThreads threads on a Queue holding times
+ * Each thread deletes an element and inserts it again, later by a random increment
+ */
+template <class Queue>
+double holdThroughput(int nThreads, const std::vector<double>& times, std::size_t ops) {
+    Queue queue(nThreads);
+    for (double t : times) {
+        queue.insert(t);
+    }
+
+    const std::size_t opsPerThread = ops / static_cast<std::size_t>(nThreads);
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        for (int i = 0; i < nThreads; ++i) {
+            threads.emplace_back([&queue, opsPerThread, i] {
+                std::mt19937 g(static_cast<unsigned>(i));
+                std::exponential_distribution<double> increment(1.0);
+                for (std::size_t k = 0; k < opsPerThread; ++k) {
+                    if (const auto t = queue.tryDeleteMin()) {
+                        queue.insert(*t + increment(g));
+                    }
+                }
+            });
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(opsPerThread * static_cast<std::size_t>(nThreads)) / elapsed.count() / 1e6;
+}
+
+/**
+ * Mean and maximum rank error of n / 2 deleteMin on a MultiQueue of nQueues queues holding 0, ..., n - 1
+ * The ranks are counted by a Fenwick tree of the elements still in the queue
+ */
+std::pair<double, std::size_t> rankError(int nQueues, std::size_t n, std::mt19937& g) {
+    std::vector<int> values(n);
+    std::iota(values.begin(), values.end(), 0);
+    std::shuffle(values.begin(), values.end(), g);
+
+    MultiQueue<int, PriorityQueue<int>> queue(nQueues, 1);
+    std::vector<std::size_t> tree(n + 1, 0);  // Fenwick tree, 1-based
+    for (int v : values) {
+        queue.insert(v);
+        for (std::size_t i = static_cast<std::size_t>(v) + 1; i <= n; i += i & (~i + 1)) {
+            ++tree[i];
+        }
+    }
+
+    double total = 0.0;
+    std::size_t max = 0;
+    const std::size_t deletes = n / 2;
+    for (std::size_t k = 0; k < deletes; ++k) {
+        const int v = *queue.tryDeleteMin();
+        std::size_t rank = 0;  // elements smaller than v
+        for (std::size_t i = static_cast<std::size_t>(v); i > 0; i -= i & (~i + 1)) {
+            rank += tree[i];
+        }
+        for (std::size_t i = static_cast<std::size_t>(v) + 1; i <= n; i += i & (~i + 1)) {
+            --tree[i];
+        }
+        total += static_cast<double>(rank);
+        max = std::max(max, rank);
+    }
+    return {total / static_cast<double>(deletes), max};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg{argv[i]};
+        if (arg == "--max-threads") {
+            cfg.maxThreads = std::max(std::stoi(argv[i + 1]), 1);
+        } else if (arg == "--size") {
+            cfg.size = std::max<std::size_t>(std::stoull(argv[i + 1]), 2);
+        } else if (arg == "--ops") {
+            cfg.ops = std::stoull(argv[i + 1]);
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::mt19937 g(2024);
+    std::uniform_real_distribution<double> time(0.0, 1.0);
+    std::vector<double> times(cfg.size);
+    std::generate(times.begin(), times.end(), [&] { return time(g); });
+
+    fmt::print("Hold throughput (million operations per second), n = {}, {} hardware threads\n", cfg.size,
+               std::thread::hardware_concurrency());
+    fmt::print("{:>8} {:>14} {:>14}\n", "threads", "locked heap", "MultiQueue");
+    for (int t = 1; t <= cfg.maxThreads; t *= 2) {
+        fmt::print("{:>8} {:>14.2f} {:>14.2f}\n", t, holdThroughput<LockedPriorityQueue>(t, times, cfg.ops),
+                   holdThroughput<MultiQueue<double, PriorityQueue<double>>>(t, times, cfg.ops));
+    }
+
+    fmt::print("\nRank error of deleteMin, one thread, n = {}\n", cfg.size);
+    fmt::print("{:>8} {:>14} {:>14}\n", "queues", "mean", "max");
+    for (int q = 1; q <= 256; q *= 4) {
+        const auto [mean, max] = rankError(q, cfg.size, g);
+        fmt::print("{:>8} {:>14.1f} {:>14}\n", q, mean, max);
+    }
+}
@@ -0,0 +1,250 @@
+/*
+ * Replay of the priority queue operations of a simulation on every queue implementation
+ *
+ * Usage: bench_queue_replay --record particles.txt trace.bin [--time T]
+ *        bench_queue_replay --replay trace.bin [--max-ops N] [--skip-vector]
+ *   --record       simulate the particles for T time units (default 10), without rendering,
+ *                  and write the operations on the queue of CollisionSystem::simulate to trace.bin
+ *   --replay       replay trace.bin on each queue
+ *   --max-ops      replay only the first N operations of the trace
+ *   --skip-vector  do not replay on SortedVectorQueue, whose insert is O(n)
+ *
+ * Reported for each queue:
+ *   ms:           time of the replay, including the construction and destruction of the queue
+ *   Mops/s:       inserted, deleted, and removed events per microsecond
+ *   peak:         largest number of events in the queue
+ *   comparisons:  calls of operator< or operator> of the events, by the queue;
+ *                 KeyedPriorityQueue compares the keys it stores, which are not counted
+ * Every deleteMin is checked against the recorded time, a mismatch is reported
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <span>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cstddef>
+
+#include <particlesystem/particle.h>
+#include <particlesystem/collisionsystem.h>
+#include <particlesystem/queuetrace.h>
+#include <particlesystem/priorityqueue.h>
+#include <particlesystem/keyedpriorityqueue.h>
+#include <particlesystem/bheap.h>
+#include <particlesystem/pairingheap.h>
+#include <particlesystem/calendarqueue.h>
+#include <particlesystem/priorityqueue-vector.h>
+
+#include <fmt/format.h>
+
+using namespace particlesystem;
+
+namespace {
+
+/**
+ * An event of the replay: its time, and a payload making it as large as an Event
+ * Each comparison is counted
+ */
+struct ReplayEvent {
+    ReplayEvent() = default;
+    explicit ReplayEvent(double t) : time{t} {}
+
+    double scheduledTime() const { return time; }
+
+    bool operator<(const ReplayEvent& e) const {
+        ++comparisons;
+        return time < e.time;
+    }
+
+    bool operator>(const ReplayEvent& e) const {
+        ++comparisons;
+        return time > e.time;
+    }
+
+    double time = 0.0;
+    std::array<std::byte, sizeof(Event) - sizeof(double)> payload{};
+
+    static inline std::size_t comparisons = 0;
+};
+
+static_assert(sizeof(ReplayEvent) == sizeof(Event));
+
+/**
+ * Read particles for the simulation from file, as lab3.cpp
+ */
+std::vector<Particle> read_particles(const std::string& file) {
+    std::ifstream is(file);
+    int n_particles = 0;
+    is >> n_particles;
+
+    std::vector<Particle> particles;
+    double rx, ry, vx, vy, radius, mass;
+    float r, g, b;
+    for (int i = 0; i < n_particles && is >> rx >> ry >> vx >> vy >> radius >> mass >> r >> g >> b; ++i) {
+        particles.push_back(Particle{.r = {rx, ry},
+                                     .v = {vx, vy},
+                                     .radius = radius,
+                                     .mass = mass,
+                                     .color = {r / 255.0f, g / 255.0f, b / 255.0f}});
+    }
+    return particles;
+}
+
+/**
+ * Simulate the particles of particlesFile for simulationTime and write the trace of the queue to traceFile
+ */
+int record(const std::string& particlesFile, const std::string& traceFile, double simulationTime) {
+    std::vector<Particle> particles = read_particles(particlesFile);
+    if (particles.empty()) {
+        std::cerr << "No particles in " << particlesFile << "\n";
+        return 1;
+    }
+
+    QueueTrace trace;
+    CollisionSystem system{std::move(particles)};
+    system.renderCallback = [](std::span<Particle>) {};
+    system.abortCallback = [] { return false; };
+    system.trace = &trace;
+    system.simulate(simulationTime, 10);
+
+    std::ofstream os(traceFile, std::ios::binary);
+    trace.write(os);
+    if (!os) {
+        std::cerr << "Cannot write " << traceFile << "\n";
+        return 1;
+    }
+    fmt::print("{} operations: {} inserted, {} deleted, {} removed events\n", trace.operations().size(),
+               trace.insertedTimes().size(), trace.deletedTimes().size(), trace.removedTimes().size());
+    return 0;
+}
+
+/**
+ * Replay the first maxOps operations of trace on a Queue of ReplayEvents and print the results
+ */
+template <class Queue>
+void replay(std::string_view name, const QueueTrace& trace, size_t maxOps) {
+    // the events are created before the clock starts
+    std::vector<ReplayEvent> inserted(trace.insertedTimes().begin(), trace.insertedTimes().end());
+    const std::vector<double>& deleted = trace.deletedTimes();
+    const std::vector<double>& removed = trace.removedTimes();
+
+    size_t nextInserted = 0;
+    size_t nextDeleted = 0;
+    size_t nextRemoved = 0;
+    size_t peak = 0;
+    size_t mismatches = 0;
+    std::unordered_map<double, size_t> toRemove;  // events to remove by a purge, by time
+
+    ReplayEvent::comparisons = 0;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        Queue queue;
+        const size_t nOps = std::min(maxOps, trace.operations().size());
+        for (size_t i = 0; i < nOps; ++i) {
+            const auto [op, count] = trace.operations()[i];
+            switch (op) {
+                case QueueTrace::Op::insert_batch:
+                    queue.insert_batch(std::span{inserted}.subspan(nextInserted, count));
+                    nextInserted += count;
+                    peak = std::max(peak, queue.size());
+                    break;
+                case QueueTrace::Op::deleteMin:
+                    for (std::uint32_t k = 0; k < count; ++k) {
+                        if (queue.isEmpty() || queue.deleteMin().time != deleted[nextDeleted]) {
+                            ++mismatches;
+                        }
+                        ++nextDeleted;
+                    }
+                    break;
+                case QueueTrace::Op::purge:
+                    // events with equal times are interchangeable for the queues
+                    toRemove.clear();
+                    for (std::uint32_t k = 0; k < count; ++k) {
+                        ++toRemove[removed[nextRemoved++]];
+                    }
+                    if (queue.remove_if([&toRemove](const ReplayEvent& e) {
+                            const auto it = toRemove.find(e.time);
+                            if (it == toRemove.end() || it->second == 0) {
+                                return false;
+                            }
+                            --it->second;
+                            return true;
+                        }) != count) {
+                        ++mismatches;
+                    }
+                    break;
+            }
+        }
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double ms = elapsed.count();
+    const double events = static_cast<double>(nextInserted + nextDeleted + nextRemoved);
+    fmt::print("{:>12} {:>10.1f} {:>10.2f} {:>10} {:>14}\n", name, ms, events / (1000.0 * ms), peak,
+               ReplayEvent::comparisons);
+    if (mismatches > 0) {
+        fmt::print("{:>12} {} operations did not match the trace\n", "", mismatches);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+
+    if (args.size() >= 3 && args[0] == "--record") {
+        double simulationTime = 10.0;
+        if (args.size() == 5 && args[3] == "--time") {
+            simulationTime = std::stod(args[4]);
+        } else if (args.size() != 3) {
+            std::cerr << "Usage: bench_queue_replay --record particles.txt trace.bin [--time T]\n";
+            return 1;
+        }
+        return record(args[1], args[2], simulationTime);
+    }
+
+    if (args.size() < 2 || args[0] != "--replay") {
+        std::cerr << "Usage: bench_queue_replay --record particles.txt trace.bin [--time T]\n"
+                  << "       bench_queue_replay --replay trace.bin [--max-ops N] [--skip-vector]\n";
+        return 1;
+    }
+
+    size_t maxOps = std::numeric_limits<size_t>::max();
+    bool skipVector = false;
+    for (size_t i = 2; i < args.size(); ++i) {
+        if (args[i] == "--max-ops" && i + 1 < args.size()) {
+            maxOps = std::stoull(args[++i]);
+        } else if (args[i] == "--skip-vector") {
+            skipVector = true;
+        } else {
+            std::cerr << "Unknown option " << args[i] << "\n";
+            return 1;
+        }
+    }
+
+    std::ifstream is(args[1], std::ios::binary);
+    const QueueTrace trace = QueueTrace::read(is);
+    if (!is) {
+        std::cerr << "Cannot read a trace from " << args[1] << "\n";
+        return 1;
+    }
+
+    fmt::print("Replay of {} of {} operations, {} events inserted\n", std::min(maxOps, trace.operations().size()),
+               trace.operations().size(), trace.insertedTimes().size());
+    fmt::print("{:>12} {:>10} {:>10} {:>10} {:>14}\n", "queue", "ms", "Mops/s", "peak", "comparisons");
+    replay<PriorityQueue<ReplayEvent, 2>>("arity 2", trace, maxOps);
+    replay<PriorityQueue<ReplayEvent, 4>>("arity 4", trace, maxOps);
+    replay<PriorityQueue<ReplayEvent, 8>>("arity 8", trace, maxOps);
+    replay<KeyedPriorityQueue<ReplayEvent, 4>>("keyed 4", trace, maxOps);
+    replay<BHeap<ReplayEvent>>("B-heap", trace, maxOps);
+    replay<PairingHeap<ReplayEvent>>("pairing", trace, maxOps);
+    replay<CalendarQueue<ReplayEvent>>("calendar", trace, maxOps);
+    if (!skipVector) {
+        replay<SortedVectorQueue<ReplayEvent>>("vector", trace, maxOps);
+    }
+}
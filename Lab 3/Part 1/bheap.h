@@ -0,0 +1,424 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cassert>
+
+#include <particlesystem/cachealignedallocator.h>
+
+/**
+ * A heap based priority queue where the root is the smallest element -- min heap
+ * B-heap layout (Kamp, 2010): the binary heap is stored in pages of at most PageBytes bytes, each page
+ * holding subtrees of several levels, so percolating through these levels touches a single page,
+ * i.e. a single TLB entry or cache line, instead of one per level in the flat array layout
+ *
+ * A page has B = 2^d slots, slot i has the children 2i and 2i + 1 in the same page,
+ * except the B / 2 leaves of the page, slots B / 2, ..., B - 1
+ * The first page holds the root in slot 1 and slot 0 is unused; every other page holds two
+ * sibling subtrees, rooted in slots 2 and 3, and slots 0 and 1 are unused
+ * The children of leaf i of page p are the two roots of page p * B / 2 + 1 + (i - B / 2),
+ * so both children are always in the same page
+ * Pages are filled one after another, so the elements are the first n used slots of the
+ * storage, and the parent of a slot always precedes it
+ */
+template <class Comparable, std::size_t PageBytes = 4096>
+class BHeap {
+public:
+    /**
+     * Constructor to create a queue with the given capacity
+     */
+    explicit BHeap(int initCapacity = 100);
+
+    /**
+     * Constructor to initialize a priority queue based on a given vector V
+     */
+    explicit BHeap(const std::vector<Comparable>& V);
+
+    // Disable copying
+    BHeap(const BHeap&) = delete;
+    BHeap& operator=(const BHeap&) = delete;
+
+    /**
+     * Make the queue empty
+     */
+    void makeEmpty();
+
+    /**
+     * Check is the queue is empty
+     * Return true if the queue is empty, false otherwise
+     */
+    bool isEmpty() const { return count == 0; }
+
+    /**
+     * Get the size of the queue, i.e. number of elements in the queue
+     */
+    size_t size() const { return count; }
+
+    /**
+     * Get the smallest element in the queue
+     */
+    Comparable findMin();
+
+    /**
+     * Remove and return the smallest element in the queue
+     * The element is moved out of the queue, not copied
+     */
+    Comparable deleteMin();
+
+    /**
+     * Add a new element x to the queue
+     */
+    void insert(const Comparable& x);
+
+    /**
+     * Add a new element x to the queue, moved into the queue
+     */
+    void insert(Comparable&& x);
+
+    /**
+     * Add a new element to the queue, constructed in place from args
+     */
+    template <class... Args>
+    void emplace(Args&&... args);
+
+    /**
+     * Add all elements of the batch to the queue
+     * A batch at least as large as the queue is appended and the whole heap rebuilt bottom-up, O(n + k)
+     * Otherwise each element is percolated up
+     */
+    void insert_batch(std::span<const Comparable> batch);
+
+    /**
+     * Remove all elements x such that pred(x) is true
+     * The remaining elements are compacted in one pass and the heap rebuilt bottom-up -- O(n)
+     * Return the number of removed elements
+     */
+    template <class Predicate>
+    size_t remove_if(Predicate pred);
+
+private:
+    // slots per page, a power of two, at least 4
+    static constexpr size_t B = std::max(std::bit_floor(PageBytes / sizeof(Comparable)), size_t{4});
+    static constexpr size_t root = 1;
+
+    std::vector<Comparable, AlignedAllocator<Comparable, PageBytes>> heap;  // pages of B slots
+    size_t count;                                                            // number of elements
+
+    static size_t page(size_t s) { return s / B; }
+    static size_t slot(size_t s) { return s % B; }
+
+    /**
+     * Test whether position s holds an element or is an unused slot of its page
+     */
+    static bool isUsed(size_t s) { return slot(s) >= (page(s) == 0 ? 1 : 2); }
+
+    /**
+     * Position in heap of element number k, 0-based, in storage order
+     * The first page holds B - 1 elements, the other ones B - 2
+     */
+    static size_t position(size_t k) {
+        return k < B - 1 ? root + k : (1 + (k - (B - 1)) / (B - 2)) * B + 2 + (k - (B - 1)) % (B - 2);
+    }
+
+    /**
+     * Position in heap of the parent of the element at position s, s is not the root
+     */
+    static size_t parent(size_t s);
+
+    /**
+     * Position in heap of the first child of the element at position s, the second child follows
+     */
+    static size_t firstChild(size_t s) {
+        return slot(s) < B / 2 ? s + slot(s) : (page(s) * (B / 2) + 1 + slot(s) - B / 2) * B + 2;
+    }
+
+    /**
+     * Position of the last element
+     */
+    size_t last() const { return heap.size() - 1; }
+
+    // Auxiliary member functions
+
+    /**
+     * Append x after the last element, starting a new page if needed
+     */
+    void append(Comparable&& x);
+
+    /**
+     * Remove the last element, and the unused slots of its page if it was the only one
+     */
+    void removeLast();
+
+    /**
+     * Restore the heap property
+     * Floyd's bottom-up construction: percolate down every internal node, from the last one -- O(n)
+     */
+    void heapify();
+
+    /**
+     * Test whether heap is a min heap
+     */
+    bool isMinHeap() const;
+
+    /**
+     * Move the element at position hole up to its place
+     */
+    void percolateUp(size_t hole);
+
+    /**
+     * Move the element at position hole down to its place
+     */
+    void percolateDown(size_t hole);
+};
+
+/* *********************** Member functions implementation *********************** */
+
+/**
+ * Constructor to create a queue with the given capacity
+ */
+template <class Comparable, std::size_t PageBytes>
+BHeap<Comparable, PageBytes>::BHeap(int initCapacity) {
+    heap.reserve(initCapacity + initCapacity / (B - 1) + 1);
+    makeEmpty();
+    assert(isEmpty());
+}
+
+/**
+ * Constructor to initialize a priority queue based on a given vector V
+ */
+template <class Comparable, std::size_t PageBytes>
+BHeap<Comparable, PageBytes>::BHeap(const std::vector<Comparable>& V) : BHeap(static_cast<int>(V.size())) {
+    insert_batch(V);
+}
+
+/**
+ * Make the queue empty
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::makeEmpty() {
+    heap.clear();
+    heap.resize(root);  // unused slot of the first page
+    count = 0;
+}
+
+/**
+ * Get the smallest element in the queue
+ */
+template <class Comparable, std::size_t PageBytes>
+Comparable BHeap<Comparable, PageBytes>::findMin() {
+    assert(!isEmpty());
+    return heap[root];
+}
+
+/**
+ * Remove and return the smallest element in the queue
+ */
+template <class Comparable, std::size_t PageBytes>
+Comparable BHeap<Comparable, PageBytes>::deleteMin() {
+    assert(!isEmpty());
+
+    Comparable min = std::move(heap[root]);
+    if (count > 1) {
+        heap[root] = std::move(heap[last()]);
+    }
+    removeLast();
+    if (!isEmpty()) {
+        percolateDown(root);
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+
+    return min;
+}
+
+/**
+ * Add a new element x to the queue
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::insert(const Comparable& x) {
+    emplace(x);
+}
+
+/**
+ * Add a new element x to the queue, moved into the queue
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::insert(Comparable&& x) {
+    emplace(std::move(x));
+}
+
+/**
+ * Add a new element to the queue, constructed in place from args
+ */
+template <class Comparable, std::size_t PageBytes>
+template <class... Args>
+void BHeap<Comparable, PageBytes>::emplace(Args&&... args) {
+    append(Comparable(std::forward<Args>(args)...));
+    percolateUp(last());
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+}
+
+/**
+ * Add all elements of the batch to the queue
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::insert_batch(std::span<const Comparable> batch) {
+    const bool rebuild = batch.size() >= size();
+
+    for (const Comparable& x : batch) {
+        append(Comparable(x));
+        if (!rebuild) {
+            percolateUp(last());
+        }
+    }
+    if (rebuild && !isEmpty()) {
+        heapify();
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+}
+
+/**
+ * Remove all elements x such that pred(x) is true
+ */
+template <class Comparable, std::size_t PageBytes>
+template <class Predicate>
+size_t BHeap<Comparable, PageBytes>::remove_if(Predicate pred) {
+    const size_t n = count;
+
+    // compact the kept elements into the first used slots, the k-th kept one never moves forward
+    count = 0;
+    for (size_t s = root; s < heap.size(); ++s) {
+        if (isUsed(s) && !pred(std::as_const(heap[s]))) {
+            if (const size_t t = position(count); t != s) {
+                heap[t] = std::move(heap[s]);
+            }
+            ++count;
+        }
+    }
+    heap.resize(isEmpty() ? root : position(count - 1) + 1);
+    if (!isEmpty()) {
+        heapify();
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+
+    return n - count;
+}
+
+/* ******************* Private member functions ********************* */
+
+/**
+ * Position in heap of the parent of the element at position s
+ */
+template <class Comparable, std::size_t PageBytes>
+size_t BHeap<Comparable, PageBytes>::parent(size_t s) {
+    assert(s != root);
+    if (page(s) == 0 || slot(s) >= 4) {
+        return page(s) * B + slot(s) / 2;  // in the same page
+    }
+    // s is a root of its page, a child of a leaf of the parent page
+    const size_t p = page(s) - 1;
+    return (p / (B / 2)) * B + B / 2 + p % (B / 2);
+}
+
+/**
+ * Append x after the last element, starting a new page if needed
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::append(Comparable&& x) {
+    if (slot(heap.size()) == 0) {
+        heap.resize(heap.size() + 2);  // unused slots of the new page
+    }
+    heap.push_back(std::move(x));
+    ++count;
+}
+
+/**
+ * Remove the last element, and the unused slots of its page if it was the only one
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::removeLast() {
+    heap.pop_back();
+    if (!isUsed(last()) && last() > 0) {
+        heap.resize(heap.size() - 2);
+    }
+    --count;
+}
+
+/**
+ * Restore the heap property
+ * The internal nodes are not all before the parent of the last element, as in a flat heap:
+ * the full pages before the last page have internal nodes too, so every slot is visited
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::heapify() {
+    assert(!isEmpty());
+    for (size_t s = last() + 1; s-- > root;) {
+        if (isUsed(s)) {
+            percolateDown(s);
+        }
+    }
+}
+
+/**
+ * Test whether heap is a min heap
+ */
+template <class Comparable, std::size_t PageBytes>
+bool BHeap<Comparable, PageBytes>::isMinHeap() const {
+    size_t n = 0;
+    for (size_t s = root; s < heap.size(); ++s) {
+        if (!isUsed(s)) continue;
+        ++n;
+        if (s != root && heap[s] < heap[parent(s)]) return false;
+    }
+    return n == count;
+}
+
+/**
+ * Function to percolate up node
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::percolateUp(size_t hole) {
+    Comparable x = std::move(heap[hole]);
+    while (hole != root && x < heap[parent(hole)]) {
+        heap[hole] = std::move(heap[parent(hole)]);
+        hole = parent(hole);
+    }
+    heap[hole] = std::move(x);
+}
+
+/**
+ * Function to percolate down node
+ */
+template <class Comparable, std::size_t PageBytes>
+void BHeap<Comparable, PageBytes>::percolateDown(size_t hole) {
+    const size_t end = last();
+    Comparable x = std::move(heap[hole]);
+    while (firstChild(hole) <= end) {
+        size_t child = firstChild(hole);
+        if (child != end && heap[child + 1] < heap[child]) {
+            ++child;
+        }
+
+        if (!(heap[child] < x)) break;
+
+        heap[hole] = std::move(heap[child]);
+        hole = child;
+    }
+    heap[hole] = std::move(x);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <new>
+#include <cstddef>
+
+/**
+ * Allocator of storage aligned to Alignment bytes, used by the heap based priority queues
+ */
+template <class T, std::size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    static constexpr std::size_t alignment = Alignment;
+
+    AlignedAllocator() = default;
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignment}));
+    }
+
+    void deallocate(T* p, std::size_t) { ::operator delete(p, std::align_val_t{alignment}); }
+
+    template <class U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const {
+        return true;
+    }
+};
+
+/**
+ * Allocator of storage aligned to a cache line
+ */
+template <class T>
+using CacheAlignedAllocator = AlignedAllocator<T, 64>;
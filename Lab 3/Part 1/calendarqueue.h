@@ -0,0 +1,411 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cmath>
+#include <cassert>
+
+#include <particlesystem/prioritykey.h>
+
+/**
+ * A calendar queue (Brown, 1988): a priority queue for the timestamps of an event-driven
+ * simulation, where the elements are mostly inserted later than the last deleted one
+ *
+ * The time axis is divided into days of length width, and the days into years of nBuckets days
+ * Bucket i holds the elements of day i of every year, sorted, so deleteMin scans the buckets
+ * of the current year from the current day on, like the pages of a calendar
+ * When the size doubles or halves, the number of buckets follows and the width is set to about
+ * three times the average distance between the smallest elements, so that a bucket holds a few
+ * elements and insert and deleteMin are O(1) on average
+ *
+ * The timestamp of an element is its PriorityKey, e.g. Event::scheduledTime()
+ * Equal elements are deleted in the order they were inserted (FIFO)
+ * Elements smaller than the last deleted one are allowed, but make deleteMin scan from their day
+ */
+template <class Comparable>
+class CalendarQueue {
+public:
+    /**
+     * Constructor to create a queue with the given capacity
+     */
+    explicit CalendarQueue(int initCapacity = 100);
+
+    /**
+     * Constructor to initialize a priority queue based on a given vector V
+     */
+    explicit CalendarQueue(const std::vector<Comparable>& V);
+
+    // Disable copying
+    CalendarQueue(const CalendarQueue&) = delete;
+    CalendarQueue& operator=(const CalendarQueue&) = delete;
+
+    /**
+     * Make the queue empty
+     */
+    void makeEmpty();
+
+    /**
+     * Check is the queue is empty
+     * Return true if the queue is empty, false otherwise
+     */
+    bool isEmpty() const { return count == 0; }
+
+    /**
+     * Get the size of the queue, i.e. number of elements in the queue
+     */
+    size_t size() const { return count; }
+
+    /**
+     * Get the smallest element in the queue
+     */
+    Comparable findMin();
+
+    /**
+     * Remove and return the smallest element in the queue
+     * The element is moved out of the queue, not copied
+     */
+    Comparable deleteMin();
+
+    /**
+     * Add a new element x to the queue
+     */
+    void insert(const Comparable& x);
+
+    /**
+     * Add a new element x to the queue, moved into the queue
+     */
+    void insert(Comparable&& x);
+
+    /**
+     * Add a new element to the queue, constructed in place from args
+     */
+    template <class... Args>
+    void emplace(Args&&... args);
+
+    /**
+     * Add all elements of the batch to the queue -- O(k) on average
+     */
+    void insert_batch(std::span<const Comparable> batch);
+
+    /**
+     * Remove all elements x such that pred(x) is true
+     * Every bucket is compacted, and the buckets are redistributed if the size halved -- O(n)
+     * Return the number of removed elements
+     */
+    template <class Predicate>
+    size_t remove_if(Predicate pred);
+
+private:
+    static constexpr size_t minBuckets = 16;  // the number of buckets is a power of two
+    static constexpr size_t sampleSize = 25;  // smallest elements used to set the width
+
+    // bucket i holds the elements of day i of every year, in decreasing order: the smallest is at the back
+    std::vector<std::vector<Comparable>> buckets;
+    size_t mask;         // nBuckets - 1
+    double width;        // length of a day
+    double invWidth;     // 1 / width
+    std::int64_t today;  // day of the last deleted element, no element is in an earlier day
+    size_t count;        // number of elements
+
+    // Auxiliary member functions
+
+    /**
+     * Day of the given priority, i.e. the priority divided by width, over all years
+     */
+    std::int64_t dayOfPriority(double priority) const;
+
+    std::int64_t day(const Comparable& x) const { return dayOfPriority(priority(x)); }
+
+    /**
+     * Priority of x as a number, given by PriorityKey
+     */
+    static double priority(const Comparable& x) { return static_cast<double>(PriorityKey<Comparable>::key(x)); }
+
+    /**
+     * Bucket of the given day
+     */
+    std::vector<Comparable>& bucket(std::int64_t d) { return buckets[static_cast<std::uint64_t>(d) & mask]; }
+
+    /**
+     * Put x in its bucket, after the elements equal to x
+     */
+    void place(Comparable&& x);
+
+    /**
+     * Find the bucket with the smallest element and advance today to its day
+     */
+    std::vector<Comparable>& locateMin();
+
+    /**
+     * Redistribute the elements over nBuckets buckets, with a width fitted to the smallest elements
+     */
+    void resize(size_t nBuckets);
+
+    /**
+     * Test whether every bucket is sorted and holds only elements of its days, from today on
+     */
+    bool isCalendar() const;
+};
+
+/* *********************** Member functions implementation *********************** */
+
+/**
+ * Constructor to create a queue with the given capacity
+ */
+template <class Comparable>
+CalendarQueue<Comparable>::CalendarQueue(int initCapacity) {
+    makeEmpty();
+    while (2 * buckets.size() < static_cast<size_t>(initCapacity)) {
+        buckets.resize(2 * buckets.size());
+    }
+    mask = buckets.size() - 1;
+    assert(isEmpty());
+}
+
+/**
+ * Constructor to initialize a priority queue based on a given vector V
+ */
+template <class Comparable>
+CalendarQueue<Comparable>::CalendarQueue(const std::vector<Comparable>& V) : CalendarQueue(static_cast<int>(V.size())) {
+    insert_batch(V);
+}
+
+/**
+ * Make the queue empty
+ */
+template <class Comparable>
+void CalendarQueue<Comparable>::makeEmpty() {
+    buckets.clear();
+    buckets.resize(minBuckets);
+    mask = minBuckets - 1;
+    width = invWidth = 1.0;
+    today = 0;
+    count = 0;
+}
+
+/**
+ * Get the smallest element in the queue
+ */
+template <class Comparable>
+Comparable CalendarQueue<Comparable>::findMin() {
+    assert(!isEmpty());
+    return locateMin().back();
+}
+
+/**
+ * Remove and return the smallest element in the queue
+ */
+template <class Comparable>
+Comparable CalendarQueue<Comparable>::deleteMin() {
+    assert(!isEmpty());
+
+    std::vector<Comparable>& b = locateMin();
+    Comparable min = std::move(b.back());
+    b.pop_back();
+    --count;
+
+    if (!isEmpty() && count < buckets.size() / 2 && buckets.size() > minBuckets) {
+        resize(buckets.size() / 2);
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isCalendar());
+#endif
+
+    return min;
+}
+
+/**
+ * Add a new element x to the queue
+ */
+template <class Comparable>
+void CalendarQueue<Comparable>::insert(const Comparable& x) {
+    emplace(x);
+}
+
+/**
+ * Add a new element x to the queue, moved into the queue
+ */
+template <class Comparable>
+void CalendarQueue<Comparable>::insert(Comparable&& x) {
+    emplace(std::move(x));
+}
+
+/**
+ * Add a new element to the queue, constructed in place from args
+ */
+template <class Comparable>
+template <class... Args>
+void CalendarQueue<Comparable>::emplace(Args&&... args) {
+    Comparable x(std::forward<Args>(args)...);
+    const std::int64_t d = day(x);
+    if (isEmpty() || d < today) {
+        today = d;
+    }
+    place(std::move(x));
+    ++count;
+
+    if (count > 2 * buckets.size()) {
+        resize(2 * buckets.size());
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isCalendar());
+#endif
+}
+
+/**
+ * Add all elements of the batch to the queue
+ */
+template <class Comparable>
+void CalendarQueue<Comparable>::insert_batch(std::span<const Comparable> batch) {
+    for (const Comparable& x : batch) {
+        emplace(x);
+    }
+}
+
+/**
+ * Remove all elements x such that pred(x) is true
+ */
+template <class Comparable>
+template <class Predicate>
+size_t CalendarQueue<Comparable>::remove_if(Predicate pred) {
+    size_t removed = 0;
+    for (std::vector<Comparable>& b : buckets) {
+        removed += std::erase_if(b, pred);
+    }
+    count -= removed;
+
+    if (!isEmpty() && count < buckets.size() / 2 && buckets.size() > minBuckets) {
+        resize(std::max(std::bit_ceil(count), minBuckets));
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isCalendar());
+#endif
+
+    return removed;
+}
+
+/* ******************* Private member functions ********************* */
+
+/**
+ * Day of the given priority, i.e. the priority divided by width, over all years
+ * Clamped, so that huge priorities do not overflow
+ */
+template <class Comparable>
+std::int64_t CalendarQueue<Comparable>::dayOfPriority(double priority) const {
+    constexpr double limit = 0x1p62;
+    const double d = std::floor(priority * invWidth);
+    return static_cast<std::int64_t>(std::clamp(d, -limit, limit));
+}
+
+/**
+ * Put x in its bucket, after the elements equal to x
+ * The bucket is decreasing, so x goes before the elements not larger than x -- O(bucket size)
+ */
+template <class Comparable>
+void CalendarQueue<Comparable>::place(Comparable&& x) {
+    std::vector<Comparable>& b = bucket(day(x));
+    auto it = std::partition_point(b.begin(), b.end(), [&x](const Comparable& y) { return x < y; });
+    b.insert(it, std::move(x));
+}
+
+/**
+ * Find the bucket with the smallest element and advance today to its day
+ * The buckets of one year are scanned from today on; if the year has no element,
+ * the smallest element is found directly among the smallest elements of all buckets
+ */
+template <class Comparable>
+std::vector<Comparable>& CalendarQueue<Comparable>::locateMin() {
+    assert(!isEmpty());
+
+    for (size_t i = 0; i < buckets.size(); ++i, ++today) {
+        std::vector<Comparable>& b = bucket(today);
+        if (!b.empty() && day(b.back()) == today) {
+            return b;
+        }
+    }
+
+    // direct search
+    std::vector<Comparable>* min = nullptr;
+    for (std::vector<Comparable>& b : buckets) {
+        if (!b.empty() && (min == nullptr || b.back() < min->back())) {
+            min = &b;
+        }
+    }
+    today = day(min->back());
+    return *min;
+}
+
+/**
+ * Redistribute the elements over nBuckets buckets, with a width fitted to the smallest elements
+ */
+template <class Comparable>
+void CalendarQueue<Comparable>::resize(size_t nBuckets) {
+    assert(!isEmpty());
+
+    // width: three times the average distance between the smallest elements,
+    // ignoring distances more than twice the average
+    std::vector<double> sample;
+    sample.reserve(count);
+    for (const std::vector<Comparable>& b : buckets) {
+        for (const Comparable& x : b) {
+            sample.push_back(priority(x));
+        }
+    }
+    const size_t k = std::min(sample.size(), sampleSize);
+    std::nth_element(sample.begin(), sample.begin() + (k - 1), sample.end());
+    std::sort(sample.begin(), sample.begin() + k);
+
+    if (k > 1) {
+        const double average = (sample[k - 1] - sample[0]) / static_cast<double>(k - 1);
+        double total = 0.0;
+        size_t n = 0;
+        for (size_t i = 1; i < k; ++i) {
+            const double distance = sample[i] - sample[i - 1];
+            if (distance <= 2.0 * average) {
+                total += distance;
+                ++n;
+            }
+        }
+        if (total > 0.0 && std::isfinite(total)) {
+            width = 3.0 * total / static_cast<double>(n);
+            invWidth = 1.0 / width;
+        }
+    }
+
+    std::vector<std::vector<Comparable>> old = std::exchange(buckets, std::vector<std::vector<Comparable>>(nBuckets));
+    mask = nBuckets - 1;
+
+    // equal elements share a bucket and are moved in the order they are deleted, which keeps them FIFO
+    for (std::vector<Comparable>& b : old) {
+        for (auto it = b.rbegin(); it != b.rend(); ++it) {
+            place(std::move(*it));
+        }
+    }
+    today = dayOfPriority(sample[0]);  // the smallest priority
+}
+
+/**
+ * Test whether every bucket is sorted and holds only elements of its days, from today on
+ */
+template <class Comparable>
+bool CalendarQueue<Comparable>::isCalendar() const {
+    size_t n = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        const std::vector<Comparable>& b = buckets[i];
+        for (size_t j = 0; j < b.size(); ++j) {
+            const std::int64_t d = day(b[j]);
+            if ((static_cast<std::uint64_t>(d) & mask) != i || d < today) return false;
+            if (j > 0 && b[j - 1] < b[j]) return false;
+        }
+        n += b.size();
+    }
+    return n == count;
+}
@@ -3,22 +3,16 @@
 #include <cassert>
 #include <span>
 #include <numeric>
+#include <limits>
+#include <algorithm>
+#include <cmath>
 #include <fmt/format.h>
 
 namespace particlesystem {
 
 namespace {
 
-/**
- * Help function to add a new event between particleA and particleB to the queue
- * The event's time must be smaller than simulationTime to be added to the queue
- */
-void addEvent(double time, Particle* particleA, Particle* particleB, PriorityQueue<Event>& queue,
-              double simulationTime) {
-    if (time < simulationTime) {
-        queue.insert(Event{time, particleA, particleB});
-    }
-}
+constexpr size_t minPurgeSize = 1024;  // smaller queues are never purged
 
 }  // namespace
 
@@ -30,75 +24,193 @@ CollisionSystem::CollisionSystem(std::vector<Particle> particles)
     : particles_{std::move(particles)} {}
 
 /**
- * Update priority queue with all new events for particle
+ * Add a new event between particleA and particleB to a batch of events
+ * The event's time must be smaller than simulationTime to be added to the batch
  */
-void CollisionSystem::predict(PriorityQueue<Event>& queue, Particle& particle, double currentTime,
-                              double simulationTime) {
+void CollisionSystem::addEvent(double time, Particle* particleA, Particle* particleB, std::vector<Event>& events,
+                               double simulationTime) {
+    if (time < simulationTime) {
+        events.emplace_back(time, particleA, particleB);
+    }
+}
+
+/**
+ * Add all new events for particle to events
+ * With a grid, only the particles of the 3 x 3 cells around the particle can collide with it before
+ * it leaves its cell, which is an event as well
+ */
+void CollisionSystem::predict(std::vector<Event>& events, Particle& particle, double simulationTime) {
+    const size_t i = indexOf(particle);
+
     // particle-particle collisions
-    for (auto& p : particles_) {
-        const double dt = particle.timeToHit(p);
-        addEvent(currentTime + dt, &particle, &p, queue, simulationTime);
+    if (gridSize_ == 0) {
+        // every particle is a candidate: the store is the block
+        store_.collisionTimes(i, store_, times_);
+        for (size_t j = 0; j < particles_.size(); ++j) {
+            if (j != i && std::isfinite(times_[j])) {
+                addEvent(times_[j], &particle, &particles_[j], events, simulationTime);
+            }
+        }
+    } else {
+        for (int y = std::max(cellY_[i] - 1, 0); y <= std::min(cellY_[i] + 1, gridSize_ - 1); ++y) {
+            for (int x = std::max(cellX_[i] - 1, 0); x <= std::min(cellX_[i] + 1, gridSize_ - 1); ++x) {
+                gatherCell(x, y, i);
+            }
+        }
+        predictCandidates(events, i, simulationTime);
+        predictCrossing(events, i, simulationTime);
     }
 
-    // particle-wall collisions
+    // particle-wall collisions, the particle is at its last bounce
     const double dtX = particle.timeToHitVerticalWall();
-    addEvent(currentTime + dtX, &particle, nullptr, queue, simulationTime);
+    addEvent(store_.time[i] + dtX, &particle, nullptr, events, simulationTime);
 
     const double dtY = particle.timeToHitHorizontalWall();
-    addEvent(currentTime + dtY, nullptr, &particle, queue, simulationTime);
+    addEvent(store_.time[i] + dtY, nullptr, &particle, events, simulationTime);
 }
 
-void CollisionSystem::simulate(double simulationTime, double drawFrequenzy) {
-    PriorityQueue<Event> queue;  // the priority queue
-    double currentTime = 0.0;    // initialize simulation clock time
-
-    // add first redraw event to the queue
-    addEvent(0.0, nullptr, nullptr, queue, simulationTime);
-
-    // add all possible collisions of particle with other particles and walls to the queue
-    for (auto& particle : particles_) {
-        predict(queue, particle, currentTime, simulationTime);
+/**
+ * Add the collisions of particle i with the candidates to events, only those that will occur
+ * The particles move in straight lines from their last bounces, so a collision time does not depend on
+ * when it is computed, e.g. at a bounce or at a cell crossing: the grid finds the same collisions as brute force
+ * The candidates are cleared
+ */
+void CollisionSystem::predictCandidates(std::vector<Event>& events, size_t i, double simulationTime) {
+    store_.collisionTimes(i, candidates_, times_);
+    for (size_t k = 0; k < candidates_.size(); ++k) {
+        if (std::isfinite(times_[k])) {
+            addEvent(times_[k], &particles_[i], &particles_[candidateIndex_[k]], events, simulationTime);
+        }
     }
+    candidates_.clear();
+    candidateIndex_.clear();
+}
 
-    // the main event-driven simulation loop
-    while (!queue.isEmpty()) {
-        // get impending event, discard if invalidated
-        const Event e = queue.deleteMin();
-        if (!e.isValid()) {
-            continue;
+/**
+ * Add the particles of cell (x, y), except particle i, to the candidates
+ */
+void CollisionSystem::gatherCell(int x, int y, size_t i) {
+    for (size_t j : cells_[static_cast<size_t>(y * gridSize_ + x)]) {
+        if (j != i) {
+            candidates_.push_back(store_, j);
+            candidateIndex_.push_back(j);
         }
+    }
+}
 
-        Particle* particleA = e.particleA;  // pointer to particle A
-        Particle* particleB = e.particleB;  // pointer to particle B
+/**
+ * Add the next cell crossing of particle i, if any, to events
+ * A crossing is an event of the particle with itself
+ */
+void CollisionSystem::predictCrossing(std::vector<Event>& events, size_t i, double simulationTime) {
+    const double time = std::min(crossingTime(i, 0), crossingTime(i, 1));
+    addEvent(time, &particles_[i], &particles_[i], events, simulationTime);
+}
 
-        // update particles positions
-        for (auto& p : particles_) {
-            p.move(e.time - currentTime);
-        }
-        currentTime = e.time;  // update simulation clock
-
-        // process event: update velocity, if needed
-        if (particleA != nullptr && particleB != nullptr) {
-            particleA->bounceOff(*particleB);  // particle-particle collision
-            predict(queue, *particleA, currentTime, simulationTime);
-            predict(queue, *particleB, currentTime, simulationTime);
-        } else if (particleA != nullptr && particleB == nullptr) {
-            particleA->bounceOffVerticalWall();  // particle-horizontal wall collision
-            predict(queue, *particleA, currentTime, simulationTime);
-        } else if (particleA == nullptr && particleB != nullptr) {
-            particleB->bounceOffHorizontalWall();  // particle-vertical wall collision
-            predict(queue, *particleB, currentTime, simulationTime);
-        } else if (particleA == nullptr && particleB == nullptr) {
-            renderCallback(particles_);
-
-            // add another rendering event to the queue
-            addEvent(currentTime + 1.0 / drawFrequenzy, nullptr, nullptr, queue, simulationTime);
-
-            // fmt::print("Simulation Time: {:8.3f}, Queue Size: {:10}\n", currentTime, queue.size());
-
-           if (abortCallback()) break; // in case user closes the simulation window
+/**
+ * Move particle i to the next cell and add its collisions with the particles of the cells that became adjacent,
+ * i.e. the row or column of 3 cells beyond the new cell, and its next crossing
+ */
+void CollisionSystem::crossCell(std::vector<Event>& events, size_t i, double simulationTime) {
+    const int axis = crossingTime(i, 0) <= crossingTime(i, 1) ? 0 : 1;
+    const int step = particles_[i].v[axis] > 0 ? 1 : -1;
+
+    auto& from = cells_[static_cast<size_t>(cellY_[i] * gridSize_ + cellX_[i])];
+    std::erase(from, i);
+    (axis == 0 ? cellX_[i] : cellY_[i]) += step;
+    cells_[static_cast<size_t>(cellY_[i] * gridSize_ + cellX_[i])].push_back(i);
+
+    const int ahead = (axis == 0 ? cellX_[i] : cellY_[i]) + step;
+    if (ahead >= 0 && ahead < gridSize_) {
+        const int side = axis == 0 ? cellY_[i] : cellX_[i];
+        for (int k = std::max(side - 1, 0); k <= std::min(side + 1, gridSize_ - 1); ++k) {
+            gatherCell(axis == 0 ? ahead : k, axis == 0 ? k : ahead, i);
         }
+        predictCandidates(events, i, simulationTime);
+    }
+    predictCrossing(events, i, simulationTime);
+}
+
+/**
+ * Time at which particle i leaves its cell through a side perpendicular to axis (0 for x, 1 for y)
+ * Return std::numeric_limits<double>::infinity(), if the particle does not move along axis
+ * or the side is a wall
+ */
+double CollisionSystem::crossingTime(size_t i, int axis) const {
+    const double v = particles_[i].v[axis];
+    const int cell = axis == 0 ? cellX_[i] : cellY_[i];
+
+    double side = 0.0;
+    if (v > 0 && cell + 1 < gridSize_) {
+        side = static_cast<double>(cell + 1) / gridSize_;
+    } else if (v < 0 && cell > 0) {
+        side = static_cast<double>(cell) / gridSize_;
+    } else {
+        return std::numeric_limits<double>::infinity();
+    }
+    return store_.time[i] + (side - (axis == 0 ? store_.x[i] : store_.y[i])) / v;
+}
+
+/**
+ * Record that the velocity of particle p changed at time, where it is now
+ */
+void CollisionSystem::bounced(const Particle& p, double time) {
+    store_.set(indexOf(p), p, time);
+}
+
+/**
+ * Move all particles to their positions at time
+ * A particle is moved only for its own events, and all particles before rendering and at the end of a simulation
+ */
+void CollisionSystem::synchronize(double time) {
+    for (size_t i = 0; i < particles_.size(); ++i) {
+        particles_[i].r = positionAt(i, time);
+    }
+}
+
+/**
+ * Set the bounces to the current state of the particles and sort the particles in the cells of the grid
+ * The grid has as many cells as particles, at most, and no grid is used if it would have less than 3 x 3 cells
+ */
+void CollisionSystem::initialize() {
+    store_.resize(particles_.size());
+    for (size_t i = 0; i < particles_.size(); ++i) {
+        store_.set(i, particles_[i], 0.0);
+    }
+
+    gridSize_ = 0;
+    cells_.clear();
+    if (!cellList || particles_.empty()) {
+        return;
+    }
+
+    const double maxRadius = std::ranges::max(particles_, {}, &Particle::radius).radius;
+    const double size = std::min(1.0 / (2.0 * maxRadius), std::sqrt(static_cast<double>(particles_.size())));
+    if (size < 3.0) {
+        return;
+    }
+
+    gridSize_ = static_cast<int>(size);
+    cells_.resize(static_cast<size_t>(gridSize_) * static_cast<size_t>(gridSize_));
+    cellX_.resize(particles_.size());
+    cellY_.resize(particles_.size());
+    for (size_t i = 0; i < particles_.size(); ++i) {
+        cellX_[i] = std::clamp(static_cast<int>(particles_[i].r.x * gridSize_), 0, gridSize_ - 1);
+        cellY_[i] = std::clamp(static_cast<int>(particles_[i].r.y * gridSize_), 0, gridSize_ - 1);
+        cells_[static_cast<size_t>(cellY_[i] * gridSize_ + cellX_[i])].push_back(i);
+    }
+}
+
+/**
+ * Size of the queue at which the dead events are removed, given the live events
+ * Each purge is O(n) and follows at least (n - live) insertions, i.e. O(1) per insertion
+ */
+size_t CollisionSystem::purgeSize(size_t live) const {
+    if (staleRatio >= 1.0) {
+        return std::numeric_limits<size_t>::max();
     }
+    const double size = static_cast<double>(live) / (1.0 - std::max(staleRatio, 0.0));
+    return std::max(static_cast<size_t>(size), minPurgeSize);
 }
 
  /**
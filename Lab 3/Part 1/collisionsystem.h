@@ -4,21 +4,73 @@
 #include <utility>
 #include <vector>
 #include <span>
+#include <string>
 #include <functional>
+#include <algorithm>
+#include <concepts>
 
 //#define USE_PRIORITY_QUEUE_VECTOR
+//#define USE_CALENDAR_QUEUE
+//#define USE_KEYED_PRIORITY_QUEUE
+//#define USE_B_HEAP
+//#define USE_PAIRING_HEAP
 
-#ifdef USE_PRIORITY_QUEUE_VECTOR
+#if defined(USE_CALENDAR_QUEUE)
+    #include <particlesystem/calendarqueue.h>
+    template <class Comparable>
+    using PriorityQueue = CalendarQueue<Comparable>;
+#elif defined(USE_KEYED_PRIORITY_QUEUE)
+    #include <particlesystem/keyedpriorityqueue.h>
+    template <class Comparable>
+    using PriorityQueue = KeyedPriorityQueue<Comparable>;
+#elif defined(USE_B_HEAP)
+    #include <particlesystem/bheap.h>
+    template <class Comparable>
+    using PriorityQueue = BHeap<Comparable>;
+#elif defined(USE_PAIRING_HEAP)
+    #include <particlesystem/pairingheap.h>
+    template <class Comparable>
+    using PriorityQueue = PairingHeap<Comparable>;
+#elif defined(USE_PRIORITY_QUEUE_VECTOR)
     #include <particlesystem/priorityqueue-vector.h>
+    template <class Comparable>
+    using PriorityQueue = SortedVectorQueue<Comparable>;
 #else
     #include <particlesystem/priorityqueue.h>
 #endif
 
+#include <particlesystem/priorityqueueconcept.h>
 #include <particlesystem/event.h>
+#include <particlesystem/particlestore.h>
 #include <particlesystem/particle.h>
+#include <particlesystem/queuetrace.h>
 
 namespace particlesystem {
 
+/**
+ * A priority queue of events that CollisionSystem::simulate can use
+ * Besides the MinPriorityQueue operations, new events are inserted as batches and
+ * invalidated events are removed with remove_if
+ */
+template <class Queue>
+concept EventQueue = MinPriorityQueue<Queue, Event> &&
+                     requires(Queue q, std::span<const Event> batch, bool (*pred)(const Event&)) {
+                         q.insert_batch(batch);
+                         { q.remove_if(pred) } -> std::convertible_to<size_t>;
+                     };
+
+/**
+ * Live and dead events of the priority queue of a simulation
+ * An event is dead when it was invalidated by a collision before it occurred
+ */
+struct QueueMetrics {
+    size_t purges = 0;    // number of times the dead events were removed from the queue
+    size_t removed = 0;   // dead events removed by all purges
+    size_t live = 0;      // events in the queue after the last purge, all live
+    size_t dead = 0;      // dead events removed by the last purge
+    size_t peakSize = 0;  // largest number of events in the queue
+};
+
 /**
  *  CollisionSystem class represents a collection of particles
  *  moving in the unit box, according to the laws of elastic collision.
@@ -39,7 +91,9 @@ public:
     /**
      * Simulate the system of particles for the specified amount of simulationTime
      * renderFrequenzy is the number of times the particles are rendered per time unit
+     * The events are scheduled in a Queue, PriorityQueue by default, e.g. PairingHeap
      */
+    template <EventQueue Queue = PriorityQueue<Event>>
     void simulate(double simulationTime, double renderFrequenzy);
 
     /**
@@ -49,21 +103,245 @@ public:
 
     /**
      * Return a vector with all system particles
+     * During a simulation, only the particles of the last event and the rendered particles are up to date
      */
     const std::vector<Particle>& particles() const;
 
+    /**
+     * Return the metrics of the priority queue of the last simulation
+     */
+    const QueueMetrics& queueMetrics() const { return metrics_; }
+
     // To be used by for rendering
     std::function<void(std::span<Particle>)> renderCallback;
     std::function<bool()> abortCallback;
 
+    // To log the health of the queue: called at each rendering with the simulation time and the
+    // statistics of the queue as JSON, if the queue collects them, e.g. PriorityQueue<Event, 4, QueueStats>
+    std::function<void(double, const std::string&)> queueStatsCallback;
+
+    /**
+     * Dead events are removed from the queue when they may be this fraction of the queue
+     * i.e. when the queue has grown to the number of live events after the last purge
+     * divided by (1 - staleRatio); 0.5 purges when the queue doubles, 1 never purges
+     */
+    double staleRatio = 0.5;
+
+    /**
+     * If not null, the operations of simulate on its queue are recorded in trace, e.g. to replay
+     * them on other queues; the trace is not cleared by simulate
+     */
+    QueueTrace* trace = nullptr;
+
+    /**
+     * If true, a particle is tested for collisions only with the particles of its own and the adjacent
+     * cells of a uniform grid over the box, whose cells are at least as wide as the largest particle diameter;
+     * cell crossings are events of the queue. If false, every pair of particles is tested (brute force)
+     * Both modes process exactly the same collisions, see ParticleStore::collisionTimes
+     */
+    bool cellList = true;
+
 private:
     /**
-     * Update priority queue with all new events for particle
+     * Add a new event between particleA and particleB to a batch of events
+     * The event's time must be smaller than simulationTime to be added to the batch
+     */
+    static void addEvent(double time, Particle* particleA, Particle* particleB, std::vector<Event>& events,
+                         double simulationTime);
+
+    /**
+     * Add all new events for particle to events
+     * The events are then inserted into the priority queue as one batch
+     */
+    void predict(std::vector<Event>& events, Particle& particle, double simulationTime);
+
+    /**
+     * Add the collisions of particle i with the candidates to events, only those that will occur
+     * The candidates are gathered in one block, whose collision times are computed at once
+     */
+    void predictCandidates(std::vector<Event>& events, size_t i, double simulationTime);
+
+    /**
+     * Add the particles of cell (x, y), except particle i, to the candidates
+     */
+    void gatherCell(int x, int y, size_t i);
+
+    /**
+     * Add the next cell crossing of particle i, if any, to events
+     */
+    void predictCrossing(std::vector<Event>& events, size_t i, double simulationTime);
+
+    /**
+     * Move particle i to the next cell, through the side given by its next crossing,
+     * and add its collisions with the particles of the cells that became adjacent
+     */
+    void crossCell(std::vector<Event>& events, size_t i, double simulationTime);
+
+    /**
+     * Time at which particle i leaves its cell through a side perpendicular to axis (0 for x, 1 for y)
+     */
+    double crossingTime(size_t i, int axis) const;
+
+    /**
+     * Record that the velocity of particle p changed at time
+     */
+    void bounced(const Particle& p, double time);
+
+    /**
+     * Position of particle i at time, from its position at its last bounce
+     */
+    glm::dvec2 positionAt(size_t i, double time) const {
+        return glm::dvec2{store_.x[i], store_.y[i]} + glm::dvec2{store_.vx[i], store_.vy[i]} * (time - store_.time[i]);
+    }
+
+    /**
+     * Move all particles to their positions at time
+     */
+    void synchronize(double time);
+
+    /**
+     * Index of particle p in particles_
+     */
+    size_t indexOf(const Particle& p) const { return static_cast<size_t>(&p - particles_.data()); }
+
+    /**
+     * Set the bounces to the current state of the particles and sort the particles in the cells of the grid
+     */
+    void initialize();
+
+    /**
+     * Size of the queue at which the dead events are removed, given the live events
      */
-    void predict(PriorityQueue<Event>& queue, Particle& particle, double currentTime,
-                 double simulationTime);
+    size_t purgeSize(size_t live) const;
 
     std::vector<Particle> particles_;  // the particles
+    QueueMetrics metrics_;             // of the last simulation
+
+    ParticleStore store_;                 // the particles at their last change of velocity
+    ParticleStore candidates_;            // particles that may collide with the particle being predicted
+    std::vector<size_t> candidateIndex_;  // index of each candidate in particles_
+    ParticleStore::Array times_;          // collision times with the candidates
+
+    int gridSize_ = 0;                        // number of cells along each side, 0 if there is no grid
+    std::vector<std::vector<size_t>> cells_;  // particles in each cell, row by row
+    std::vector<int> cellX_;                  // cell column of each particle
+    std::vector<int> cellY_;                  // cell row of each particle
 };
 
+/**
+ * Simulate the system of particles for the specified amount of simulationTime
+ * Defined here, as the queue is a template parameter
+ */
+template <EventQueue Queue>
+void CollisionSystem::simulate(double simulationTime, double drawFrequenzy) {
+    Queue queue;               // the priority queue
+    double currentTime = 0.0;  // initialize simulation clock time
+    metrics_ = QueueMetrics{};
+
+    std::vector<Event> events;  // new events, waiting to be inserted into the queue
+    initialize();
+
+    // add first redraw event to the queue
+    addEvent(0.0, nullptr, nullptr, events, simulationTime);
+
+    // add all possible collisions of particle with other particles and walls to the queue
+    // as one batch: the heap is built bottom-up in linear time
+    for (auto& particle : particles_) {
+        predict(events, particle, simulationTime);
+    }
+    queue.insert_batch(events);
+    if (trace != nullptr) {
+        trace->insert(events);
+    }
+    size_t nextPurge = purgeSize(queue.size());
+
+    // the main event-driven simulation loop
+    while (!queue.isEmpty()) {
+        // get impending event, discard if invalidated
+        const Event e = queue.deleteMin();
+        if (trace != nullptr) {
+            trace->deleteMin(e);
+        }
+        if (!e.isValid()) {
+            continue;
+        }
+
+        Particle* particleA = e.particleA;  // pointer to particle A
+        Particle* particleB = e.particleB;  // pointer to particle B
+
+        // update the positions of the particles of the event, unless a particle only crosses into another cell
+        // the other particles are moved before rendering
+        const bool crossing = particleA != nullptr && particleA == particleB;
+        if (!crossing) {
+            for (Particle* p : {particleA, particleB}) {
+                if (p != nullptr) {
+                    p->r = positionAt(indexOf(*p), e.time);
+                }
+            }
+            currentTime = e.time;  // update simulation clock
+        }
+
+        // process event: update velocity, if needed
+        events.clear();
+        if (crossing) {
+            crossCell(events, indexOf(*particleA), simulationTime);  // particle-cell side crossing
+        } else if (particleA != nullptr && particleB != nullptr) {
+            particleA->bounceOff(*particleB);  // particle-particle collision
+            bounced(*particleA, currentTime);
+            bounced(*particleB, currentTime);
+            predict(events, *particleA, simulationTime);
+            predict(events, *particleB, simulationTime);
+        } else if (particleA != nullptr && particleB == nullptr) {
+            particleA->bounceOffVerticalWall();  // particle-horizontal wall collision
+            bounced(*particleA, currentTime);
+            predict(events, *particleA, simulationTime);
+        } else if (particleA == nullptr && particleB != nullptr) {
+            particleB->bounceOffHorizontalWall();  // particle-vertical wall collision
+            bounced(*particleB, currentTime);
+            predict(events, *particleB, simulationTime);
+        } else if (particleA == nullptr && particleB == nullptr) {
+            synchronize(currentTime);
+            renderCallback(particles_);
+
+            // add another rendering event to the queue
+            addEvent(currentTime + 1.0 / drawFrequenzy, nullptr, nullptr, events, simulationTime);
+
+            // fmt::print("Simulation Time: {:8.3f}, Queue Size: {:10}\n", currentTime, queue.size());
+            if constexpr (requires { queue.stats().toJson(); }) {
+                if (queueStatsCallback) {
+                    queueStatsCallback(currentTime, queue.stats().toJson());
+                }
+            }
+
+           if (abortCallback()) break; // in case user closes the simulation window
+        }
+        queue.insert_batch(events);
+        if (trace != nullptr) {
+            trace->insert(events);
+        }
+        metrics_.peakSize = std::max(metrics_.peakSize, queue.size());
+
+        // remove the events invalidated since the last purge
+        if (queue.size() >= nextPurge) {
+            metrics_.dead = queue.remove_if([this](const Event& e) {
+                if (e.isValid()) {
+                    return false;
+                }
+                if (trace != nullptr) {
+                    trace->remove(e);
+                }
+                return true;
+            });
+            if (trace != nullptr) {
+                trace->purge();
+            }
+            metrics_.live = queue.size();
+            metrics_.removed += metrics_.dead;
+            ++metrics_.purges;
+            nextPurge = purgeSize(queue.size());
+        }
+    }
+    synchronize(currentTime);
+}
+
 }  // namespace particlesystem
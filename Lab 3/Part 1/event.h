@@ -12,11 +12,12 @@ class CollisionSystem;
 /**
  *  An event during a particle collision simulation. Each event contains
  *  the time at which it will occur and the particles a and b involved.
- *  There are 4 types of events:
+ *  There are 5 types of events:
  *    -  a and b both null:      rendering event
  *    -  a null, b not null:     collision with vertical wall
  *    -  a not null, b null:     collision with horizontal wall
  *    -  a and b both not null:  binary collision between a and b
+ *    -  a and b the same:       a crosses a side of its cell, see CollisionSystem::cellList
  *
  */
 class Event {
@@ -37,6 +38,11 @@ public:
      */
     bool isValid() const;
 
+    /**
+     * Time that the event is scheduled to occur
+     */
+    double scheduledTime() const { return time; }
+
     friend CollisionSystem;
 
 private:
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cassert>
+
+/**
+ * A heap based priority queue where the root is the smallest element -- min heap
+ * Each inserted element gets a handle, to change its priority or to remove it later in O(log n)
+ *
+ * The heap is a 0-based d-ary heap, as in PriorityQueue, storing each element with its handle
+ * A position map, updated whenever percolation moves an element, gives the heap position of
+ * each handle
+ * A handle stays valid until its element is removed by deleteMin or erase; then the handle
+ * may be given to a new element
+ */
+template <class Comparable, int Arity = 4>
+class IndexedPriorityQueue {
+    static_assert(Arity == 2 || Arity == 4 || Arity == 8, "Arity must be 2, 4, or 8");
+
+public:
+    using Handle = int;
+
+    /**
+     * Constructor to create a queue with the given capacity
+     */
+    explicit IndexedPriorityQueue(int initCapacity = 100);
+
+    // Disable copying
+    IndexedPriorityQueue(const IndexedPriorityQueue&) = delete;
+    IndexedPriorityQueue& operator=(const IndexedPriorityQueue&) = delete;
+
+    /**
+     * Make the queue empty, all handles become invalid
+     */
+    void makeEmpty();
+
+    /**
+     * Check is the queue is empty
+     * Return true if the queue is empty, false otherwise
+     */
+    bool isEmpty() const { return heap.empty(); }
+
+    /**
+     * Get the size of the queue, i.e. number of elements in the queue
+     */
+    size_t size() const { return heap.size(); }
+
+    /**
+     * Get the smallest element in the queue
+     */
+    const Comparable& findMin() const;
+
+    /**
+     * Remove and return the smallest element in the queue
+     */
+    Comparable deleteMin();
+
+    /**
+     * Add a new element x to the queue
+     * Return the handle of x
+     */
+    Handle insert(const Comparable& x);
+
+    Handle insert(Comparable&& x);
+
+    /**
+     * Add a new element to the queue, constructed in place from args
+     * Return the handle of the element
+     */
+    template <class... Args>
+    Handle emplace(Args&&... args);
+
+    /**
+     * Return true if h is the handle of an element in the queue
+     */
+    bool contains(Handle h) const;
+
+    /**
+     * Get the element with handle h
+     */
+    const Comparable& operator[](Handle h) const;
+
+    /**
+     * Replace the element with handle h by x, which must not be larger -- O(log n)
+     */
+    void decreaseKey(Handle h, Comparable x);
+
+    /**
+     * Replace the element with handle h by x, which must not be smaller -- O(log n)
+     */
+    void increaseKey(Handle h, Comparable x);
+
+    /**
+     * Replace the element with handle h by x, larger or smaller -- O(log n)
+     */
+    void update(Handle h, Comparable x);
+
+    /**
+     * Remove and return the element with handle h -- O(log n)
+     */
+    Comparable erase(Handle h);
+
+private:
+    // an element of the heap and its handle
+    struct Entry {
+        Comparable value;
+        Handle handle;
+    };
+
+    static constexpr int notInQueue = -1;
+
+    std::vector<Entry> heap;        // the d-ary heap, root is heap[0]
+    std::vector<int> position;      // position[h] is the index in heap of handle h, or notInQueue
+    std::vector<Handle> freeHandles;  // handles of removed elements, for reuse
+
+    // Auxiliary member functions
+
+    static int parent(int i) { return (i - 1) / Arity; }
+    static int firstChild(int i) { return Arity * i + 1; }
+
+    /**
+     * Put entry e at position i of the heap and record the position of its handle
+     */
+    void place(int i, Entry&& e);
+
+    /**
+     * Remove the entry at position i of the heap and return it
+     */
+    Entry removeAt(int i);
+
+    /**
+     * Test whether heap is a min heap and position is consistent with it
+     */
+    bool isMinHeap() const;
+
+    /**
+     * Move the entry at position hole up or down to its place
+     */
+    void percolateUp(int hole);
+    void percolateDown(int hole);
+};
+
+/* *********************** Member functions implementation *********************** */
+
+/**
+ * Constructor to create a queue with the given capacity
+ */
+template <class Comparable, int Arity>
+IndexedPriorityQueue<Comparable, Arity>::IndexedPriorityQueue(int initCapacity) {
+    heap.reserve(initCapacity);
+    position.reserve(initCapacity);
+    assert(isEmpty());
+}
+
+/**
+ * Make the queue empty, all handles become invalid
+ */
+template <class Comparable, int Arity>
+void IndexedPriorityQueue<Comparable, Arity>::makeEmpty() {
+    heap.clear();
+    position.clear();
+    freeHandles.clear();
+}
+
+/**
+ * Get the smallest element in the queue
+ */
+template <class Comparable, int Arity>
+const Comparable& IndexedPriorityQueue<Comparable, Arity>::findMin() const {
+    assert(!isEmpty());
+    return heap[0].value;
+}
+
+/**
+ * Remove and return the smallest element in the queue
+ */
+template <class Comparable, int Arity>
+Comparable IndexedPriorityQueue<Comparable, Arity>::deleteMin() {
+    assert(!isEmpty());
+    return removeAt(0).value;
+}
+
+/**
+ * Add a new element x to the queue
+ */
+template <class Comparable, int Arity>
+auto IndexedPriorityQueue<Comparable, Arity>::insert(const Comparable& x) -> Handle {
+    return emplace(x);
+}
+
+template <class Comparable, int Arity>
+auto IndexedPriorityQueue<Comparable, Arity>::insert(Comparable&& x) -> Handle {
+    return emplace(std::move(x));
+}
+
+/**
+ * Add a new element to the queue, constructed in place from args
+ */
+template <class Comparable, int Arity>
+template <class... Args>
+auto IndexedPriorityQueue<Comparable, Arity>::emplace(Args&&... args) -> Handle {
+    Handle h;
+    if (freeHandles.empty()) {
+        h = static_cast<Handle>(position.size());
+        position.push_back(notInQueue);
+    } else {
+        h = freeHandles.back();
+        freeHandles.pop_back();
+    }
+
+    heap.push_back(Entry{Comparable(std::forward<Args>(args)...), h});
+    position[h] = static_cast<int>(heap.size()) - 1;
+    percolateUp(position[h]);
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+    return h;
+}
+
+/**
+ * Return true if h is the handle of an element in the queue
+ */
+template <class Comparable, int Arity>
+bool IndexedPriorityQueue<Comparable, Arity>::contains(Handle h) const {
+    return h >= 0 && h < static_cast<Handle>(position.size()) && position[h] != notInQueue;
+}
+
+/**
+ * Get the element with handle h
+ */
+template <class Comparable, int Arity>
+const Comparable& IndexedPriorityQueue<Comparable, Arity>::operator[](Handle h) const {
+    assert(contains(h));
+    return heap[position[h]].value;
+}
+
+/**
+ * Replace the element with handle h by x, which must not be larger
+ */
+template <class Comparable, int Arity>
+void IndexedPriorityQueue<Comparable, Arity>::decreaseKey(Handle h, Comparable x) {
+    assert(contains(h) && !(heap[position[h]].value < x));
+    heap[position[h]].value = std::move(x);
+    percolateUp(position[h]);
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+}
+
+/**
+ * Replace the element with handle h by x, which must not be smaller
+ */
+template <class Comparable, int Arity>
+void IndexedPriorityQueue<Comparable, Arity>::increaseKey(Handle h, Comparable x) {
+    assert(contains(h) && !(x < heap[position[h]].value));
+    heap[position[h]].value = std::move(x);
+    percolateDown(position[h]);
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+}
+
+/**
+ * Replace the element with handle h by x, larger or smaller
+ */
+template <class Comparable, int Arity>
+void IndexedPriorityQueue<Comparable, Arity>::update(Handle h, Comparable x) {
+    assert(contains(h));
+    if (x < heap[position[h]].value) {
+        decreaseKey(h, std::move(x));
+    } else {
+        increaseKey(h, std::move(x));
+    }
+}
+
+/**
+ * Remove and return the element with handle h
+ */
+template <class Comparable, int Arity>
+Comparable IndexedPriorityQueue<Comparable, Arity>::erase(Handle h) {
+    assert(contains(h));
+    return removeAt(position[h]).value;
+}
+
+/* ******************* Private member functions ********************* */
+
+/**
+ * Put entry e at position i of the heap and record the position of its handle
+ */
+template <class Comparable, int Arity>
+void IndexedPriorityQueue<Comparable, Arity>::place(int i, Entry&& e) {
+    position[e.handle] = i;
+    heap[i] = std::move(e);
+}
+
+/**
+ * Remove the entry at position i of the heap and return it
+ * The last entry fills the hole, and is percolated up or down from there
+ */
+template <class Comparable, int Arity>
+auto IndexedPriorityQueue<Comparable, Arity>::removeAt(int i) -> Entry {
+    Entry removed = std::move(heap[i]);
+    position[removed.handle] = notInQueue;
+    freeHandles.push_back(removed.handle);
+
+    Entry last = std::move(heap.back());
+    heap.pop_back();
+    if (i < static_cast<int>(heap.size())) {
+        const bool smaller = last.value < removed.value;
+        place(i, std::move(last));
+        if (smaller) {
+            percolateUp(i);
+        } else {
+            percolateDown(i);
+        }
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+    return removed;
+}
+
+/**
+ * Test whether heap is a min heap and position is consistent with it
+ */
+template <class Comparable, int Arity>
+bool IndexedPriorityQueue<Comparable, Arity>::isMinHeap() const {
+    const int n = static_cast<int>(heap.size());
+    for (int i = 0; i < n; ++i) {
+        if (position[heap[i].handle] != i) return false;
+        if (i > 0 && heap[i].value < heap[parent(i)].value) return false;
+    }
+    return true;
+}
+
+/**
+ * Function to percolate up node
+ */
+template <class Comparable, int Arity>
+void IndexedPriorityQueue<Comparable, Arity>::percolateUp(int hole) {
+    Entry x = std::move(heap[hole]);
+    while (hole > 0 && x.value < heap[parent(hole)].value) {
+        place(hole, std::move(heap[parent(hole)]));
+        hole = parent(hole);
+    }
+    place(hole, std::move(x));
+}
+
+/**
+ * Function to percolate down node
+ */
+template <class Comparable, int Arity>
+void IndexedPriorityQueue<Comparable, Arity>::percolateDown(int hole) {
+    const int n = static_cast<int>(heap.size());
+    Entry x = std::move(heap[hole]);
+    while (firstChild(hole) < n) {
+        const int first = firstChild(hole);
+        const int last = (first + Arity <= n) ? first + Arity : n;
+        int child = first;
+        for (int c = first + 1; c < last; ++c) {
+            if (heap[c].value < heap[child].value) child = c;
+        }
+
+        if (!(heap[child].value < x.value)) break;
+
+        place(hole, std::move(heap[child]));
+        hole = child;
+    }
+    place(hole, std::move(x));
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <span>
+#include <utility>
+#include <limits>
+#include <type_traits>
+#include <bit>
+#include <cstdint>
+#include <cassert>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+#include <particlesystem/cachealignedallocator.h>
+#include <particlesystem/prioritykey.h>
+
+/**
+ * A heap based priority queue where the root is the smallest element -- min heap
+ * The same d-ary heap as PriorityQueue, but the heap stores only the keys of the elements,
+ * given by PriorityKey, e.g. Event::scheduledTime(), and the index of each element in a
+ * separate payload array: percolation reads and moves keys, not whole elements
+ *
+ * The keys are contiguous and cache aligned as in PriorityQueue, and the group of children
+ * after the last node is filled with the largest key, so that the smallest child is always
+ * searched among Arity keys; with AVX2, 4 or 8 double keys are compared at once
+ * Elements are deleted in the same order as by PriorityQueue
+ */
+template <class Comparable, int Arity = 4>
+class KeyedPriorityQueue {
+    static_assert(Arity == 2 || Arity == 4 || Arity == 8, "Arity must be 2, 4, or 8");
+
+public:
+    using Key = std::remove_cvref_t<decltype(PriorityKey<Comparable>::key(std::declval<const Comparable&>()))>;
+
+    /**
+     * Constructor to create a queue with the given capacity
+     */
+    explicit KeyedPriorityQueue(int initCapacity = 100);
+
+    /**
+     * Constructor to initialize a priority queue based on a given vector V
+     */
+    explicit KeyedPriorityQueue(const std::vector<Comparable>& V);
+
+    // Disable copying
+    KeyedPriorityQueue(const KeyedPriorityQueue&) = delete;
+    KeyedPriorityQueue& operator=(const KeyedPriorityQueue&) = delete;
+
+    /**
+     * Make the queue empty
+     */
+    void makeEmpty();
+
+    /**
+     * Check is the queue is empty
+     * Return true if the queue is empty, false otherwise
+     */
+    bool isEmpty() const { return ids.empty(); }
+
+    /**
+     * Get the size of the queue, i.e. number of elements in the queue
+     */
+    size_t size() const { return ids.size(); }
+
+    /**
+     * Get the smallest element in the queue
+     */
+    Comparable findMin();
+
+    /**
+     * Remove and return the smallest element in the queue
+     * The element is moved out of the queue, not copied
+     */
+    Comparable deleteMin();
+
+    /**
+     * Add a new element x to the queue
+     */
+    void insert(const Comparable& x);
+
+    /**
+     * Add a new element x to the queue, moved into the queue
+     */
+    void insert(Comparable&& x);
+
+    /**
+     * Add a new element to the queue, constructed in place from args
+     */
+    template <class... Args>
+    void emplace(Args&&... args);
+
+    /**
+     * Add all elements of the batch to the queue
+     * A batch at least as large as the queue is appended and the whole heap rebuilt bottom-up, O(n + k)
+     * Otherwise each element is percolated up, O(k) on average and O(k log(n + k)) in the worst case
+     */
+    void insert_batch(std::span<const Comparable> batch);
+
+    /**
+     * Remove all elements x such that pred(x) is true
+     * The remaining nodes are compacted in one pass and the heap rebuilt bottom-up -- O(n)
+     * Return the number of removed elements
+     */
+    template <class Predicate>
+    size_t remove_if(Predicate pred);
+
+private:
+    static constexpr int offset = Arity - 1;  // number of unused slots before the root
+
+    // fills the keys after the last node
+    static constexpr Key padding =
+        std::numeric_limits<Key>::has_infinity ? std::numeric_limits<Key>::infinity() : std::numeric_limits<Key>::max();
+
+    std::vector<Key, CacheAlignedAllocator<Key>> keys;  // key of node i is keys[i + offset]
+    std::vector<std::uint32_t> ids;                     // node i holds payload[ids[i]]
+    std::vector<Comparable> payload;                    // the elements, in no order
+    std::vector<std::uint32_t> freeSlots;               // unused entries of payload
+
+    /**
+     * Key of node i of the heap, 0-based
+     */
+    Key& key(int i) { return keys[i + offset]; }
+    const Key& key(int i) const { return keys[i + offset]; }
+
+    static int parent(int i) { return (i - 1) / Arity; }
+    static int firstChild(int i) { return Arity * i + 1; }
+
+    // Auxiliary member functions
+
+    /**
+     * Store x in payload and append a node for it, not yet in its place
+     */
+    void append(Comparable&& x);
+
+    /**
+     * Index of the smallest of the Arity keys starting at node first, the first one if several
+     */
+    int smallestChild(int first) const;
+
+    /**
+     * Restore the heap property
+     * Floyd's bottom-up construction: percolate down every internal node, from the last one -- O(n)
+     */
+    void heapify();
+
+    /**
+     * Test whether the keys form a min heap
+     */
+    bool isMinHeap() const;
+
+    /**
+     * Move the node at position hole up to its place
+     */
+    void percolateUp(int hole);
+
+    /**
+     * Move the node at position hole down to its place
+     */
+    void percolateDown(int hole);
+};
+
+/* *********************** Member functions implementation *********************** */
+
+/**
+ * Constructor to create a queue with the given capacity
+ */
+template <class Comparable, int Arity>
+KeyedPriorityQueue<Comparable, Arity>::KeyedPriorityQueue(int initCapacity) {
+    keys.reserve(initCapacity + 2 * Arity);
+    ids.reserve(initCapacity);
+    payload.reserve(initCapacity);
+    makeEmpty();
+    assert(isEmpty());
+}
+
+/**
+ * Constructor to initialize a priority queue based on a given vector V
+ */
+template <class Comparable, int Arity>
+KeyedPriorityQueue<Comparable, Arity>::KeyedPriorityQueue(const std::vector<Comparable>& V)
+    : KeyedPriorityQueue(static_cast<int>(V.size())) {
+    insert_batch(V);
+}
+
+/**
+ * Make the queue empty
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::makeEmpty() {
+    keys.assign(Arity, padding);  // unused slots and the root group
+    ids.clear();
+    payload.clear();
+    freeSlots.clear();
+}
+
+/**
+ * Get the smallest element in the queue
+ */
+template <class Comparable, int Arity>
+Comparable KeyedPriorityQueue<Comparable, Arity>::findMin() {
+    assert(!isEmpty());
+    return payload[ids[0]];
+}
+
+/**
+ * Remove and return the smallest element in the queue
+ */
+template <class Comparable, int Arity>
+Comparable KeyedPriorityQueue<Comparable, Arity>::deleteMin() {
+    assert(!isEmpty());
+
+    const std::uint32_t id = ids[0];
+    Comparable min = std::move(payload[id]);
+    freeSlots.push_back(id);
+
+    const int last = static_cast<int>(size()) - 1;
+    key(0) = key(last);
+    ids[0] = ids[last];
+    key(last) = padding;
+    ids.pop_back();
+    if (!isEmpty()) {
+        percolateDown(0);
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+
+    return min;
+}
+
+/**
+ * Add a new element x to the queue
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::insert(const Comparable& x) {
+    emplace(x);
+}
+
+/**
+ * Add a new element x to the queue, moved into the queue
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::insert(Comparable&& x) {
+    emplace(std::move(x));
+}
+
+/**
+ * Add a new element to the queue, constructed in place from args
+ */
+template <class Comparable, int Arity>
+template <class... Args>
+void KeyedPriorityQueue<Comparable, Arity>::emplace(Args&&... args) {
+    append(Comparable(std::forward<Args>(args)...));
+    percolateUp(static_cast<int>(size()) - 1);
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+}
+
+/**
+ * Add all elements of the batch to the queue
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::insert_batch(std::span<const Comparable> batch) {
+    const bool rebuild = batch.size() >= size();
+
+    for (const Comparable& x : batch) {
+        append(Comparable(x));
+        if (!rebuild) {
+            percolateUp(static_cast<int>(size()) - 1);
+        }
+    }
+    if (rebuild && !isEmpty()) {
+        heapify();
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+}
+
+/**
+ * Remove all elements x such that pred(x) is true
+ */
+template <class Comparable, int Arity>
+template <class Predicate>
+size_t KeyedPriorityQueue<Comparable, Arity>::remove_if(Predicate pred) {
+    const int n = static_cast<int>(size());
+    int kept = 0;
+    for (int i = 0; i < n; ++i) {
+        if (pred(std::as_const(payload[ids[i]]))) {
+            freeSlots.push_back(ids[i]);
+        } else {
+            key(kept) = key(i);
+            ids[kept] = ids[i];
+            ++kept;
+        }
+    }
+    for (int i = kept; i < n; ++i) {
+        key(i) = padding;
+    }
+    ids.resize(kept);
+    if (kept < n && !isEmpty()) {
+        heapify();
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+
+    return static_cast<size_t>(n - kept);
+}
+
+/* ******************* Private member functions ********************* */
+
+/**
+ * Store x in payload and append a node for it, not yet in its place
+ * The keys always extend to the end of the group of children of the last node
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::append(Comparable&& x) {
+    const Key k = PriorityKey<Comparable>::key(x);
+
+    std::uint32_t id;
+    if (freeSlots.empty()) {
+        id = static_cast<std::uint32_t>(payload.size());
+        payload.push_back(std::move(x));
+    } else {
+        id = freeSlots.back();
+        freeSlots.pop_back();
+        payload[id] = std::move(x);
+    }
+
+    ids.push_back(id);
+    const int n = static_cast<int>(size());
+    if (keys.size() < static_cast<size_t>(n + offset)) {
+        keys.resize(keys.size() + Arity, padding);
+    }
+    key(n - 1) = k;
+}
+
+/**
+ * Index of the smallest of the Arity keys starting at node first, the first one if several
+ * The group is aligned to Arity keys; nodes past the last one hold padding
+ */
+template <class Comparable, int Arity>
+int KeyedPriorityQueue<Comparable, Arity>::smallestChild(int first) const {
+    const Key* k = &key(first);
+
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<Key, double> && Arity >= 4) {
+        // minimum of the group in every lane, then the first lane equal to it
+        __m256d lo = _mm256_load_pd(k);
+        __m256d m = lo;
+        if constexpr (Arity == 8) {
+            m = _mm256_min_pd(lo, _mm256_load_pd(k + 4));
+        }
+        m = _mm256_min_pd(m, _mm256_permute2f128_pd(m, m, 1));
+        m = _mm256_min_pd(m, _mm256_permute_pd(m, 0b0101));
+
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(lo, m, _CMP_EQ_OQ)));
+        if constexpr (Arity == 8) {
+            const __m256d hi = _mm256_load_pd(k + 4);
+            mask |= static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(hi, m, _CMP_EQ_OQ))) << 4;
+        }
+        if (mask != 0) {  // no NaN keys
+            return first + std::countr_zero(mask);
+        }
+    }
+#endif
+
+    int child = 0;
+    for (int c = 1; c < Arity; ++c) {
+        if (k[c] < k[child]) child = c;
+    }
+    return first + child;
+}
+
+/**
+ * Restore the heap property
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::heapify() {
+    assert(!isEmpty());
+    for (int i = parent(static_cast<int>(size()) - 1); i >= 0; --i) {
+        percolateDown(i);
+    }
+}
+
+/**
+ * Test whether the keys form a min heap
+ */
+template <class Comparable, int Arity>
+bool KeyedPriorityQueue<Comparable, Arity>::isMinHeap() const {
+    const int n = static_cast<int>(size());
+    for (int i = 0; i < n; ++i) {
+        if (key(i) != PriorityKey<Comparable>::key(payload[ids[i]])) return false;
+        if (i > 0 && key(i) < key(parent(i))) return false;
+    }
+    return true;
+}
+
+/**
+ * Function to percolate up node
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::percolateUp(int hole) {
+    const Key k = key(hole);
+    const std::uint32_t id = ids[hole];
+    while (hole > 0 && k < key(parent(hole))) {
+        key(hole) = key(parent(hole));
+        ids[hole] = ids[parent(hole)];
+        hole = parent(hole);
+    }
+    key(hole) = k;
+    ids[hole] = id;
+}
+
+/**
+ * Function to percolate down node
+ */
+template <class Comparable, int Arity>
+void KeyedPriorityQueue<Comparable, Arity>::percolateDown(int hole) {
+    const int n = static_cast<int>(size());
+    const Key k = key(hole);
+    const std::uint32_t id = ids[hole];
+    while (firstChild(hole) < n) {
+        const int child = smallestChild(firstChild(hole));
+        if (!(key(child) < k)) break;
+
+        key(hole) = key(child);
+        ids[hole] = ids[child];
+        hole = child;
+    }
+    key(hole) = k;
+    ids[hole] = id;
+}
@@ -1,5 +1,6 @@
 #include <vector>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <cassert>
 #include <random>
@@ -7,9 +8,19 @@
 #include <filesystem>
 #include <algorithm>
 #include <numeric>
+#include <chrono>
+#include <iterator>
+#include <thread>
+#include <atomic>
 
 #include <particlesystem/particle.h>
 #include <particlesystem/collisionsystem.h>
+#include <particlesystem/indexedpriorityqueue.h>
+#include <particlesystem/calendarqueue.h>
+#include <particlesystem/keyedpriorityqueue.h>
+#include <particlesystem/bheap.h>
+#include <particlesystem/pairingheap.h>
+#include <particlesystem/multiqueue.h>
 
 #include <rendering/window.h>
 
@@ -17,11 +28,42 @@
 
 using namespace particlesystem;
 
+// PriorityQueue is the d-ary heap of priorityqueue.h, not an alternative selected in collisionsystem.h
+#if !defined(USE_PRIORITY_QUEUE_VECTOR) && !defined(USE_CALENDAR_QUEUE) && !defined(USE_KEYED_PRIORITY_QUEUE) && \
+    !defined(USE_B_HEAP) && !defined(USE_PAIRING_HEAP)
+    #define PRIORITY_QUEUE_IS_HEAP
+#endif
+
+/**
+ * Time of an event with the order in which it was inserted, to test the order of equal elements
+ */
+struct TaggedTime {
+    double time;
+    int id;
+
+    double scheduledTime() const { return time; }
+    auto operator<=>(const TaggedTime& e) const { return time <=> e.time; }
+};
+
 /**
  * To test
  */
 void test4PriorityQueue();
 
+#ifdef PRIORITY_QUEUE_IS_HEAP
+/**
+ * To test KeyedPriorityQueue against PriorityQueue with the same arity
+ */
+template <int Arity>
+void testKeyedPriorityQueue(std::mt19937& g);
+#endif
+
+/**
+ * To compare the running time of PriorityQueue with arity 2, 4, and 8, KeyedPriorityQueue, BHeap, PairingHeap,
+ * and CalendarQueue
+ */
+void benchmarkPriorityQueue();
+
 /**
  * Read particles for the simulation from file
  */
@@ -35,6 +77,8 @@ void runSimulation();
 int main() {
 #ifdef TEST_PRIORITY_QUEUE
     test4PriorityQueue();
+#elif defined(BENCHMARK_PRIORITY_QUEUE)
+    benchmarkPriorityQueue();
 #else
     runSimulation();
 #endif
@@ -141,5 +185,474 @@ void test4PriorityQueue() {
             fmt::print("Oops! Error after delete of {}\n", i);
         }
     }
+
+    fmt::print("\nTest: constructor from a vector, insert_batch, deleteMin\n");
+
+    // first half builds the heap bottom-up, second half is inserted as small and large batches
+    const auto half = V.begin() + std::ssize(V) / 2;
+    PriorityQueue<int> h2{std::vector<int>(V.begin(), half)};
+    h2.insert_batch(std::span{half, half + 10});
+    h2.insert_batch(std::span{half + 10, V.end()});
+
+    for (int i = minItem; i < maxItem; ++i) {
+        int x = h2.deleteMin();
+        if (x != i) {
+            fmt::print("Oops! Error after delete of {}\n", i);
+        }
+    }
+    assert(h2.isEmpty());
+
+    fmt::print("\nTest: remove_if, deleteMin\n");
+
+    PriorityQueue<int> h4{V};
+    [[maybe_unused]] const size_t removed = h4.remove_if([](int k) { return k % 3 == 0; });
+    assert(removed + h4.size() == V.size());
+    for (int i = minItem; i < maxItem; ++i) {
+        if (i % 3 == 0) continue;
+        int x = h4.deleteMin();
+        if (x != i) {
+            fmt::print("Oops! Error after delete of {}\n", i);
+        }
+    }
+    assert(h4.isEmpty());
+
+    fmt::print("\nTest: IndexedPriorityQueue decreaseKey, increaseKey, erase\n");
+
+    // every key k is inserted as k + offset and moved to k, or erased if it is odd
+    constexpr int offset = 5000;
+    IndexedPriorityQueue<int> h3;
+    std::vector<IndexedPriorityQueue<int>::Handle> handles(maxItem + 1);
+    for (int k : V) {
+        handles[k] = h3.insert(k + offset);
+    }
+    for (int k : V) {
+        if (k % 2 == 1) {
+            h3.erase(handles[k]);
+        } else if (k % 4 == 0) {
+            h3.decreaseKey(handles[k], k);
+        } else {
+            h3.increaseKey(handles[k], k + 2 * offset);
+            h3.decreaseKey(handles[k], k);
+        }
+    }
+
+    for (int i = minItem; i < maxItem; i += 2) {
+        int x = h3.deleteMin();
+        if (x != i) {
+            fmt::print("Oops! Error after delete of {}\n", i);
+        }
+    }
+    assert(h3.isEmpty());
+
+#if defined(PRIORITY_QUEUE_IS_HEAP) || defined(USE_PAIRING_HEAP)
+    fmt::print("\nTest: deleteMin(k, out)\n");
+
+    // batches of growing size, the largest ones are selected at once
+    PriorityQueue<int> h5{V};
+    std::vector<int> deleted;
+    for (size_t k = 1; !h5.isEmpty(); k *= 4) {
+        h5.deleteMin(k, std::back_inserter(deleted));
+    }
+    for (int i = minItem; i < maxItem; ++i) {
+        if (deleted[i - minItem] != i) {
+            fmt::print("Oops! Error after delete of {}\n", i);
+        }
+    }
+#endif
+
+    fmt::print("\nTest: PairingHeap meld, decreaseKey, deleteMin(k, out)\n");
+
+    // every key k is inserted as k + offset into one of two heaps, which are melded, and moved to k
+    PairingHeap<int> h6;
+    PairingHeap<int> h7;
+    std::vector<PairingHeap<int>::Handle> pairingHandles(maxItem + 1);
+    for (int k : V) {
+        pairingHandles[k] = (k % 2 == 0 ? h6 : h7).insert(k + offset);
+    }
+    h6.meld(h7);
+    assert(h7.isEmpty() && h6.size() == V.size());
+    for (int k : V) {
+        h6.decreaseKey(pairingHandles[k], k);
+    }
+
+    std::vector<int> smallest;
+    h6.deleteMin(10, std::back_inserter(smallest));
+    for (int i = minItem; i < maxItem; ++i) {
+        int x = (i - minItem < std::ssize(smallest)) ? smallest[i - minItem] : h6.deleteMin();
+        if (x != i) {
+            fmt::print("Oops! Error after delete of {}\n", i);
+        }
+    }
+    assert(h6.isEmpty());
+
+    fmt::print("\nTest: CalendarQueue insert, deleteMin, remove_if, against PriorityQueue\n");
+
+    // the calendar grows from its minimum size while V is inserted, and shrinks while it is drained;
+    // halfway through, times earlier than the last deleted one are inserted
+    CalendarQueue<double> h9;
+    PriorityQueue<double> h10;
+    for (int k : V) {
+        h9.insert(k * 0.001);
+        h10.insert(k * 0.001);
+    }
+    for (int i = minItem; i < (minItem + maxItem) / 2; ++i) {
+        double x = h9.deleteMin();
+        if (x != h10.deleteMin()) {
+            fmt::print("Oops! Error after delete of {}\n", x);
+        }
+    }
+    for (int k = 0; k < minItem; k += 7) {
+        h9.insert(k * 0.001);
+        h10.insert(k * 0.001);
+    }
+    [[maybe_unused]] const size_t removedCalendar = h9.remove_if([](double t) { return t > 8.0; });
+    [[maybe_unused]] const size_t removedHeap = h10.remove_if([](double t) { return t > 8.0; });
+    assert(removedCalendar == removedHeap && h9.size() == h10.size());
+    while (!h10.isEmpty()) {
+        double x = h9.deleteMin();
+        if (x != h10.deleteMin()) {
+            fmt::print("Oops! Error after delete of {}\n", x);
+        }
+    }
+    assert(h9.isEmpty());
+
+    fmt::print("\nTest: CalendarQueue with equal times, FIFO\n");
+
+    // groups of 8 equal times, inserted in a random order: the events leave in the order of the times,
+    // and equal times leave in the order they were inserted, also across the resizes
+    CalendarQueue<Event> h11;
+    PriorityQueue<Event> h12;
+    CalendarQueue<TaggedTime> h13;
+    for (int id = 0; int k : V) {
+        h11.emplace((k / 8) * 0.01);
+        h12.emplace((k / 8) * 0.01);
+        h13.insert(TaggedTime{(k / 8) * 0.01, id++});
+    }
+    for (int i = minItem; i < maxItem; ++i) {
+        double t = h11.deleteMin().scheduledTime();
+        if (t != h12.deleteMin().scheduledTime()) {
+            fmt::print("Oops! Error after delete of {}\n", t);
+        }
+    }
+    assert(h11.isEmpty() && h12.isEmpty());
+    for (TaggedTime previous = h13.deleteMin(); !h13.isEmpty();) {
+        TaggedTime e = h13.deleteMin();
+        const bool inOrder = previous.time < e.time || (previous.time == e.time && previous.id < e.id);
+        if (!inOrder) {
+            fmt::print("Oops! Error after delete of {}\n", e.time);
+        }
+        assert(inOrder);
+        previous = e;
+    }
+
+#ifdef PRIORITY_QUEUE_IS_HEAP
+    fmt::print("\nTest: KeyedPriorityQueue against PriorityQueue with arity 2, 4, and 8\n");
+
+    testKeyedPriorityQueue<2>(g);
+    testKeyedPriorityQueue<4>(g);
+    testKeyedPriorityQueue<8>(g);
+#endif
+
+    fmt::print("\nTest: BHeap with small pages, insert_batch, remove_if, deleteMin, against PriorityQueue\n");
+
+    // after the first page, a page of 4 ints holds one level of the heap, a page of 16 ints three levels;
+    // while the queues are drained, the small elements are inserted again, larger by offset,
+    // so that the last pages are emptied and filled again
+    BHeap<int, 16> h14;
+    BHeap<int, 64> h15{V};
+    PriorityQueue<int> h16{V};
+    for (int k : std::span{V.begin(), half}) {
+        h14.insert(k);
+    }
+    h14.insert_batch(std::span{half, half + 10});
+    h14.insert_batch(std::span{half + 10, V.end()});
+
+    const auto multipleOf3 = [](int k) { return k % 3 == 0; };
+    [[maybe_unused]] const size_t removedSmallPages = h14.remove_if(multipleOf3);
+    [[maybe_unused]] const size_t removedPages = h15.remove_if(multipleOf3);
+    [[maybe_unused]] const size_t removedQueue = h16.remove_if(multipleOf3);
+    assert(removedSmallPages == removedQueue && removedPages == removedQueue);
+
+    while (!h16.isEmpty()) {
+        const int x = h16.deleteMin();
+        const int y = h14.deleteMin();
+        const int z = h15.deleteMin();
+        if (y != x || z != x) {
+            fmt::print("Oops! Error after delete of {}\n", x);
+        }
+        assert(y == x && z == x);
+        if (x < (minItem + maxItem) / 2) {
+            h14.insert(x + offset);
+            h15.insert(x + offset);
+            h16.insert(x + offset);
+        }
+    }
+    assert(h14.isEmpty() && h15.isEmpty());
+
+    constexpr int nThreads = 8;
+    fmt::print("\nTest: MultiQueue with {} threads, insert, tryDeleteMin\n", nThreads);
+
+    // the threads insert V and delete some elements meanwhile, then they delete the rest together:
+    // every element is deleted exactly once, and no tryDeleteMin of the second step finds the queue empty
+    MultiQueue<int, PriorityQueue<int>> h8{nThreads};
+    std::vector<std::vector<int>> deletedBy(nThreads);
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < nThreads; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = t; i < V.size(); i += nThreads) {
+                    h8.insert(V[i]);
+                    if (i % 3 == 0) {
+                        if (std::optional<int> x = h8.tryDeleteMin()) {
+                            deletedBy[t].push_back(*x);
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    const size_t remaining = h8.size();
+    std::atomic<size_t> tickets{0};
+    std::atomic<size_t> missed{0};
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < nThreads; ++t) {
+            threads.emplace_back([&, t] {
+                while (tickets.fetch_add(1) < remaining) {
+                    if (std::optional<int> x = h8.tryDeleteMin()) {
+                        deletedBy[t].push_back(*x);
+                    } else {
+                        ++missed;
+                    }
+                }
+            });
+        }
+    }
+    if (missed > 0) {
+        fmt::print("Oops! tryDeleteMin found no element {} times\n", missed.load());
+    }
+    assert(missed == 0);
+    assert(h8.isEmpty() && !h8.tryDeleteMin());
+
+    std::vector<int> timesDeleted(maxItem + 1, 0);
+    for (const std::vector<int>& deleted : deletedBy) {
+        for (int x : deleted) {
+            ++timesDeleted[x];
+        }
+    }
+    for (int i = minItem; i < maxItem; ++i) {
+        if (timesDeleted[i] != 1) {
+            fmt::print("Oops! {} deleted {} times\n", i, timesDeleted[i]);
+        }
+    }
+    assert(std::ranges::all_of(timesDeleted.begin() + minItem, timesDeleted.begin() + maxItem,
+                               [](int n) { return n == 1; }));
     fmt::print("Successful test...\n");
 }
+
+#ifdef PRIORITY_QUEUE_IS_HEAP
+/**
+ * To test KeyedPriorityQueue against PriorityQueue with the same arity
+ */
+template <int Arity>
+void testKeyedPriorityQueue(std::mt19937& g) {
+    // random inserts, batches, remove_if, and deleteMin on both queues, with many equal times:
+    // the elements leave in the same order, equal ones included, and the queues go through every
+    // size modulo Arity, i.e. every padding of the last group of children
+    // the double keys of TaggedTime are compared 4 or 8 at once with AVX2, the int keys one by one
+    KeyedPriorityQueue<TaggedTime, Arity> keyed;
+    PriorityQueue<TaggedTime, Arity> heap;
+    KeyedPriorityQueue<int, Arity> keyedInt;
+    PriorityQueue<int, Arity> heapInt;
+
+    std::uniform_int_distribution<int> operation(0, 9);
+    std::uniform_int_distribution<int> time(0, 499);
+    std::vector<TaggedTime> batch;
+    std::vector<int> batchInt;
+    int id = 0;
+
+    const auto deleteMin = [&] {
+        const TaggedTime e = keyed.deleteMin();
+        const TaggedTime f = heap.deleteMin();
+        const int k = keyedInt.deleteMin();
+        const int l = heapInt.deleteMin();
+        const bool same = e.time == f.time && e.id == f.id && k == l;
+        if (!same) {
+            fmt::print("Oops! Error after delete of {}\n", f.time);
+        }
+        assert(same);
+    };
+
+    for (int i = 0; i < 5000; ++i) {
+        const int op = operation(g);
+        if (op < 4) {
+            const int t = time(g);
+            keyed.insert(TaggedTime{static_cast<double>(t), id});
+            heap.insert(TaggedTime{static_cast<double>(t), id});
+            keyedInt.insert(t);
+            heapInt.insert(t);
+            ++id;
+        } else if (op == 4) {
+            // a batch at least as large as the queue rebuilds the heap, a smaller one is percolated up
+            const size_t k = (heap.size() < 100 && i % 2 == 0) ? heap.size() + i % Arity : i % 7;
+            batch.clear();
+            batchInt.clear();
+            for (size_t j = 0; j < k; ++j) {
+                const int t = time(g);
+                batch.push_back(TaggedTime{static_cast<double>(t), id++});
+                batchInt.push_back(t);
+            }
+            keyed.insert_batch(batch);
+            heap.insert_batch(batch);
+            keyedInt.insert_batch(batchInt);
+            heapInt.insert_batch(batchInt);
+        } else if (op == 5 && i % 8 == 0) {
+            const int m = 2 + i % 5;
+            const auto pred = [m](const TaggedTime& e) { return static_cast<int>(e.time) % m == 0; };
+            const auto predInt = [m](int t) { return t % m == 0; };
+            [[maybe_unused]] const size_t removed = keyed.remove_if(pred);
+            [[maybe_unused]] const size_t removedHeap = heap.remove_if(pred);
+            [[maybe_unused]] const size_t removedInt = keyedInt.remove_if(predInt);
+            [[maybe_unused]] const size_t removedHeapInt = heapInt.remove_if(predInt);
+            assert(removed == removedHeap && removedInt == removedHeapInt && removed == removedInt);
+        } else if (!heap.isEmpty()) {
+            deleteMin();
+        }
+        assert(keyed.size() == heap.size() && keyedInt.size() == heap.size() && heapInt.size() == heap.size());
+    }
+    while (!heap.isEmpty()) {
+        deleteMin();
+    }
+    assert(keyed.isEmpty() && keyedInt.isEmpty() && heapInt.isEmpty());
+}
+#endif
+
+/**
+ * Return the running time of f in milliseconds
+ */
+template <class F>
+double timeMs(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/**
+ * Running times of a priority queue, IntQueue of ints and EventQueue of Events
+ *   ints:   the test4PriorityQueue workload, n shuffled ints inserted and then all deleted
+ *   hold:   Events, each deleteMin followed by the insert of a later Event, the queue keeps n Events
+ *   drain:  deleteMin of all n Events left by hold, as at the end of a simulation
+ */
+template <class IntQueue, class EventQueue>
+void benchmarkQueue(std::string_view name, const std::vector<int>& V, const std::vector<double>& times,
+                    const std::vector<double>& increments) {
+    double ints = timeMs([&] {
+        IntQueue h;
+        for (int k : V) {
+            h.insert(k);
+        }
+        long sum = 0;
+        while (!h.isEmpty()) {
+            sum += h.deleteMin();
+        }
+        assert(sum == std::accumulate(V.begin(), V.end(), 0L));
+    });
+
+    EventQueue queue;
+    for (double t : times) {
+        queue.emplace(t);
+    }
+    double hold = timeMs([&] {
+        for (double dt : increments) {
+            const Event e = queue.deleteMin();
+            queue.emplace(e.scheduledTime() + dt);
+        }
+    });
+    double drain = timeMs([&] {
+        while (!queue.isEmpty()) {
+            queue.deleteMin();
+        }
+    });
+
+    fmt::print("{:>12} {:>12.1f} {:>12.1f} {:>12.1f}\n", name, ints, hold, drain);
+}
+
+#ifdef PRIORITY_QUEUE_IS_HEAP
+/**
+ * Nanoseconds per hold operation, i.e. deleteMin followed by the insert of a later time,
+ * of a Queue of the given times
+ */
+template <class Queue>
+double holdNs(const std::vector<double>& times, const std::vector<double>& increments) {
+    Queue queue{times};
+    double ms = timeMs([&] {
+        for (double dt : increments) {
+            queue.insert(queue.deleteMin() + dt);
+        }
+    });
+    return 1e6 * ms / static_cast<double>(increments.size());
+}
+
+/**
+ * To find the sizes where the B-heap layout of BHeap, with pages of a cache line or of a memory page,
+ * is faster than the flat array of PriorityQueue
+ */
+void benchmarkLayout() {
+    std::mt19937 g(2024);
+    std::uniform_real_distribution<double> time(0.0, 1.0);
+    std::exponential_distribution<double> increment(1.0);
+    std::vector<double> increments(1 << 20);
+    std::generate(increments.begin(), increments.end(), [&] { return increment(g); });
+
+    fmt::print("\nHold time (ns per deleteMin and insert) of a queue of n doubles\n");
+    fmt::print("{:>10} {:>12} {:>12} {:>12} {:>12}\n", "n", "flat 2", "flat 4", "B-heap 64", "B-heap 4096");
+    for (int logN = 12; logN <= 24; logN += 2) {
+        std::vector<double> times(size_t{1} << logN);
+        std::generate(times.begin(), times.end(), [&] { return time(g); });
+
+        fmt::print("{:>10} {:>12.1f} {:>12.1f} {:>12.1f} {:>12.1f}\n", times.size(),
+                   holdNs<PriorityQueue<double, 2>>(times, increments),
+                   holdNs<PriorityQueue<double, 4>>(times, increments),
+                   holdNs<BHeap<double, 64>>(times, increments), holdNs<BHeap<double, 4096>>(times, increments));
+    }
+}
+#endif
+
+/**
+ * To compare the running time of PriorityQueue with arity 2, 4, and 8, KeyedPriorityQueue, BHeap, PairingHeap,
+ * and CalendarQueue
+ */
+void benchmarkPriorityQueue() {
+    constexpr int n = 1 << 20;
+
+    std::mt19937 g(2024);
+    std::vector<int> V(n);
+    std::iota(V.begin(), V.end(), 0);
+    std::shuffle(V.begin(), V.end(), g);
+
+    std::uniform_real_distribution<double> time(0.0, 1.0);
+    std::exponential_distribution<double> increment(1.0);
+    std::vector<double> times(n);
+    std::vector<double> increments(4 * n);
+    std::generate(times.begin(), times.end(), [&] { return time(g); });
+    std::generate(increments.begin(), increments.end(), [&] { return increment(g); });
+
+    fmt::print("PriorityQueue running times (ms), n = {}\n", n);
+    fmt::print("{:>12} {:>12} {:>12} {:>12}\n", "queue", "ints", "Event hold", "Event drain");
+#ifdef PRIORITY_QUEUE_IS_HEAP
+    benchmarkQueue<PriorityQueue<int, 2>, PriorityQueue<Event, 2>>("arity 2", V, times, increments);
+    benchmarkQueue<PriorityQueue<int, 4>, PriorityQueue<Event, 4>>("arity 4", V, times, increments);
+    benchmarkQueue<PriorityQueue<int, 8>, PriorityQueue<Event, 8>>("arity 8", V, times, increments);
+#endif
+    benchmarkQueue<KeyedPriorityQueue<int, 4>, KeyedPriorityQueue<Event, 4>>("keyed 4", V, times, increments);
+    benchmarkQueue<KeyedPriorityQueue<int, 8>, KeyedPriorityQueue<Event, 8>>("keyed 8", V, times, increments);
+    benchmarkQueue<BHeap<int>, BHeap<Event>>("B-heap", V, times, increments);
+    benchmarkQueue<PairingHeap<int>, PairingHeap<Event>>("pairing", V, times, increments);
+    benchmarkQueue<CalendarQueue<int>, CalendarQueue<Event>>("calendar", V, times, increments);
+
+#ifdef PRIORITY_QUEUE_IS_HEAP
+    benchmarkLayout();
+#endif
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <optional>
+#include <utility>
+#include <limits>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+#include <particlesystem/prioritykey.h>
+#include <particlesystem/priorityqueueconcept.h>
+
+/**
+ * A relaxed priority queue shared by several threads: MultiQueue (Rihani, Sanders, and Dementiev, 2015)
+ *
+ * The elements are spread over c * T sequential queues of type Queue, e.g. PriorityQueue, for T threads,
+ * each behind its own try-lock; there is no global lock
+ *   insert:         adds the element to a random queue, another one if the lock is taken
+ *   tryDeleteMin:   samples two random queues and deletes the smallest element of the better one,
+ *                   comparing their smallest keys, cached outside of the locks
+ * A thread never waits for a lock held by another thread, except when all sampled queues were empty
+ * or busy: then every queue is visited in turn, so that no element is missed
+ *
+ * Quality: tryDeleteMin does not return the smallest element, but one of the smallest
+ * With q = c * T queues, in a sequential setting, the rank of the deleted element among the elements
+ * of the MultiQueue is O(q) in expectation and O(q log q) with high probability, and this does not
+ * grow with the number of operations (Alistarh, Kopinsky, Li, and Nadiradze, 2017: two choices are
+ * needed, one random queue lets the rank error grow without bound)
+ * Concurrent operations add the elements being inserted or deleted by the other threads to the error
+ * The elements of one queue are deleted in increasing order; a larger c lowers contention but
+ * raises the rank error
+ *
+ * The order of Comparable must be the order of its PriorityKey, e.g. Event::scheduledTime()
+ * size() is exact only when no insert or tryDeleteMin is in progress
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+class MultiQueue {
+public:
+    /**
+     * Constructor to create an empty queue for nThreads threads, made of c * nThreads queues
+     */
+    explicit MultiQueue(int nThreads, int c = 2);
+
+    // Disable copying
+    MultiQueue(const MultiQueue&) = delete;
+    MultiQueue& operator=(const MultiQueue&) = delete;
+
+    /**
+     * Check is the queue is empty
+     * Return true if the queue is empty, false otherwise
+     */
+    bool isEmpty() const { return size() == 0; }
+
+    /**
+     * Get the size of the queue, i.e. number of elements in the queue
+     */
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    /**
+     * Number of sequential queues
+     */
+    size_t numberOfQueues() const { return nQueues; }
+
+    /**
+     * Add a new element x to a random queue
+     */
+    void insert(const Comparable& x);
+
+    /**
+     * Add a new element x to a random queue, moved into the queue
+     */
+    void insert(Comparable&& x);
+
+    /**
+     * Add a new element to a random queue, constructed from args
+     */
+    template <class... Args>
+    void emplace(Args&&... args);
+
+    /**
+     * Remove and return one of the smallest elements of the queue, see the quality above
+     * Return no element if every queue was empty when it was visited
+     */
+    std::optional<Comparable> tryDeleteMin();
+
+private:
+    using Key = decltype(PriorityKey<Comparable>::key(std::declval<const Comparable&>()));
+
+    // cached key of an empty queue, larger than the others
+    static constexpr Key emptyKey = std::numeric_limits<Key>::has_infinity ? std::numeric_limits<Key>::infinity()
+                                                                           : std::numeric_limits<Key>::max();
+
+    // attempts of tryDeleteMin with two random queues before visiting all queues
+    static constexpr int maxAttempts = 4;
+
+    // a sequential queue with its lock, in its own cache lines
+    struct alignas(64) Shard {
+        std::atomic<bool> locked{false};
+        std::atomic<Key> top{emptyKey};  // key of the smallest element, read without the lock
+        Queue queue;
+
+        bool tryLock() {
+            return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+        }
+
+        void lock() {
+            while (!tryLock()) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() { locked.store(false, std::memory_order_release); }
+
+        /**
+         * Cache the key of the smallest element, the lock is held
+         */
+        void updateTop() {
+            top.store(queue.isEmpty() ? emptyKey : PriorityKey<Comparable>::key(queue.findMin()),
+                      std::memory_order_relaxed);
+        }
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t nQueues;
+    std::atomic<size_t> count{0};
+
+    // Auxiliary member functions
+
+    /**
+     * Index of a random queue, from a generator of the calling thread
+     */
+    size_t randomQueue() const;
+
+    /**
+     * Delete the smallest element of shard s, whose lock is held, and release the lock
+     */
+    Comparable deleteMinAndUnlock(Shard& s);
+};
+
+/* *********************** Member functions implementation *********************** */
+
+/**
+ * Constructor to create an empty queue for nThreads threads, made of c * nThreads queues
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+MultiQueue<Comparable, Queue>::MultiQueue(int nThreads, int c)
+    : shards{std::make_unique<Shard[]>(static_cast<size_t>(std::max(nThreads * c, 1)))}
+    , nQueues{static_cast<size_t>(std::max(nThreads * c, 1))} {
+    assert(isEmpty());
+}
+
+/**
+ * Add a new element x to a random queue
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+void MultiQueue<Comparable, Queue>::insert(const Comparable& x) {
+    emplace(x);
+}
+
+/**
+ * Add a new element x to a random queue, moved into the queue
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+void MultiQueue<Comparable, Queue>::insert(Comparable&& x) {
+    emplace(std::move(x));
+}
+
+/**
+ * Add a new element to a random queue, constructed from args
+ * Queues whose lock is taken are skipped
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+template <class... Args>
+void MultiQueue<Comparable, Queue>::emplace(Args&&... args) {
+    Comparable x(std::forward<Args>(args)...);
+    while (true) {
+        Shard& s = shards[randomQueue()];
+        if (s.tryLock()) {
+            s.queue.insert(std::move(x));
+            s.updateTop();
+            s.unlock();
+            break;
+        }
+    }
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Remove and return one of the smallest elements of the queue
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+std::optional<Comparable> MultiQueue<Comparable, Queue>::tryDeleteMin() {
+    // the better of two random queues, by their cached keys
+    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+        Shard& a = shards[randomQueue()];
+        Shard& b = shards[randomQueue()];
+        Shard& s = (b.top.load(std::memory_order_relaxed) < a.top.load(std::memory_order_relaxed)) ? b : a;
+        if (s.top.load(std::memory_order_relaxed) == emptyKey || !s.tryLock()) {
+            continue;
+        }
+        if (s.queue.isEmpty()) {  // the cached key was stale
+            s.unlock();
+            continue;
+        }
+        return deleteMinAndUnlock(s);
+    }
+
+    // visit every queue, from a random one
+    const size_t first = randomQueue();
+    for (size_t i = 0; i < nQueues; ++i) {
+        Shard& s = shards[(first + i) % nQueues];
+        s.lock();
+        if (!s.queue.isEmpty()) {
+            return deleteMinAndUnlock(s);
+        }
+        s.unlock();
+    }
+    return std::nullopt;
+}
+
+/* ******************* Private member functions ********************* */
+
+/**
+ * Index of a random queue
+ * xorshift64*, one generator per thread, seeded from the thread id
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+size_t MultiQueue<Comparable, Queue>::randomQueue() const {
+    thread_local std::uint64_t state =
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ull | 1;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<size_t>(((state * 0x2545F4914F6CDD1Dull) >> 32) % nQueues);
+}
+
+/**
+ * Delete the smallest element of shard s, whose lock is held, and release the lock
+ */
+template <class Comparable, class Queue>
+    requires MinPriorityQueue<Queue, Comparable>
+Comparable MultiQueue<Comparable, Queue>::deleteMinAndUnlock(Shard& s) {
+    Comparable min = s.queue.deleteMin();
+    s.updateTop();
+    s.unlock();
+    count.fetch_sub(1, std::memory_order_relaxed);
+    return min;
+}
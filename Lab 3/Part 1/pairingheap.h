@@ -0,0 +1,510 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+/**
+ * A pairing heap (Fredman, Sedgewick, Sleator, and Tarjan, 1986): a priority queue where the root
+ * is the smallest element -- min heap, that can be melded with another one in O(1)
+ *
+ * The heap is a tree of nodes, each with any number of children, none smaller than their parent
+ * Two trees are linked by making the root of the larger one the first child of the other root,
+ * so insert, meld, and decreaseKey link once, O(1)
+ * deleteMin removes the root and links its children in two passes: pairwise left to right,
+ * then the pairs right to left into one tree -- amortized O(log n)
+ *
+ * The children of a node are a doubly linked list: child is the first child, next the following
+ * sibling, and prev the preceding sibling or, for the first child, the parent
+ * Each inserted element gets a handle, to decrease its priority later
+ * A handle stays valid until its element is removed; a melded heap keeps the handles of both heaps
+ */
+template <class Comparable>
+class PairingHeap {
+    struct Node;
+
+public:
+    using Handle = Node*;
+
+    /**
+     * Constructor to create a queue with the given capacity
+     * Nodes for initCapacity elements are allocated up front
+     */
+    explicit PairingHeap(int initCapacity = 100);
+
+    /**
+     * Constructor to initialize a priority queue based on a given vector V
+     */
+    explicit PairingHeap(const std::vector<Comparable>& V);
+
+    ~PairingHeap();
+
+    // Disable copying
+    PairingHeap(const PairingHeap&) = delete;
+    PairingHeap& operator=(const PairingHeap&) = delete;
+
+    // Moving keeps the handles valid
+    PairingHeap(PairingHeap&& other) noexcept;
+    PairingHeap& operator=(PairingHeap&& other) noexcept;
+
+    /**
+     * Make the queue empty, all handles become invalid
+     */
+    void makeEmpty();
+
+    /**
+     * Check is the queue is empty
+     * Return true if the queue is empty, false otherwise
+     */
+    bool isEmpty() const { return root == nullptr; }
+
+    /**
+     * Get the size of the queue, i.e. number of elements in the queue
+     */
+    size_t size() const { return count; }
+
+    /**
+     * Get the smallest element in the queue
+     */
+    const Comparable& findMin() const;
+
+    /**
+     * Remove and return the smallest element in the queue -- amortized O(log n)
+     * The element is moved out of the queue, not copied
+     */
+    Comparable deleteMin();
+
+    /**
+     * Remove the k smallest elements, or all if fewer, and write them to out in increasing order
+     * Return the end of the written range -- amortized O(k log n)
+     */
+    template <class OutputIt>
+    OutputIt deleteMin(size_t k, OutputIt out);
+
+    /**
+     * Add a new element x to the queue -- O(1)
+     * Return the handle of x
+     */
+    Handle insert(const Comparable& x);
+
+    Handle insert(Comparable&& x);
+
+    /**
+     * Add a new element to the queue, constructed in place from args -- O(1)
+     * Return the handle of the element
+     */
+    template <class... Args>
+    Handle emplace(Args&&... args);
+
+    /**
+     * Add all elements of the batch to the queue -- O(k)
+     */
+    void insert_batch(std::span<const Comparable> batch);
+
+    /**
+     * Replace the element with handle h by x, which must not be larger -- amortized O(log n)
+     * The subtree of h is cut from its parent and linked with the root
+     */
+    void decreaseKey(Handle h, Comparable x);
+
+    /**
+     * Move all elements of other into this queue, other becomes empty -- O(1)
+     * The handles of the elements of other stay valid, as handles of this queue
+     */
+    void meld(PairingHeap& other);
+
+    /**
+     * Remove all elements x such that pred(x) is true
+     * The remaining nodes are linked again in two passes -- O(n)
+     * Return the number of removed elements
+     */
+    template <class Predicate>
+    size_t remove_if(Predicate pred);
+
+private:
+    struct Node {
+        Comparable value;
+        Node* child = nullptr;  // first child
+        Node* next = nullptr;   // following sibling
+        Node* prev = nullptr;   // preceding sibling, or parent of a first child
+    };
+
+    Node* root = nullptr;
+    size_t count = 0;              // number of elements
+    Node* freeNodes = nullptr;     // nodes of removed elements, for reuse, linked by next
+    std::vector<Node*> subtrees;   // pairs of the first pass of combineSiblings
+
+    // Auxiliary member functions
+
+    /**
+     * Return a node holding a new element constructed from args, reusing a free node if any
+     */
+    template <class... Args>
+    Node* newNode(Args&&... args);
+
+    /**
+     * Add node n to the free nodes
+     */
+    void freeNode(Node* n);
+
+    /**
+     * Link the trees of roots a and b and return the root of the result
+     * On ties, a stays the root
+     */
+    static Node* link(Node* a, Node* b);
+
+    /**
+     * Link the sibling list starting at first into one tree, in two passes, and return its root
+     */
+    Node* combineSiblings(Node* first);
+
+    /**
+     * Call f(n) for every node n of the tree of root r, in preorder
+     * f may free n: its child and sibling are read before
+     */
+    template <class F>
+    static void forEachNode(Node* r, F f);
+
+    /**
+     * Test whether no node is smaller than its parent and the links are consistent
+     */
+    bool isPairingHeap() const;
+};
+
+/* *********************** Member functions implementation *********************** */
+
+/**
+ * Constructor to create a queue with the given capacity
+ */
+template <class Comparable>
+PairingHeap<Comparable>::PairingHeap(int initCapacity) {
+    for (int i = 0; i < initCapacity; ++i) {
+        freeNode(new Node{Comparable{}});
+    }
+    assert(isEmpty());
+}
+
+/**
+ * Constructor to initialize a priority queue based on a given vector V
+ */
+template <class Comparable>
+PairingHeap<Comparable>::PairingHeap(const std::vector<Comparable>& V) : PairingHeap(0) {
+    insert_batch(V);
+}
+
+template <class Comparable>
+PairingHeap<Comparable>::~PairingHeap() {
+    makeEmpty();
+    while (freeNodes != nullptr) {
+        delete std::exchange(freeNodes, freeNodes->next);
+    }
+}
+
+template <class Comparable>
+PairingHeap<Comparable>::PairingHeap(PairingHeap&& other) noexcept
+    : root{std::exchange(other.root, nullptr)}
+    , count{std::exchange(other.count, 0)}
+    , freeNodes{std::exchange(other.freeNodes, nullptr)} {}
+
+template <class Comparable>
+PairingHeap<Comparable>& PairingHeap<Comparable>::operator=(PairingHeap&& other) noexcept {
+    // other gets the nodes of this queue, and deletes them
+    std::swap(root, other.root);
+    std::swap(count, other.count);
+    std::swap(freeNodes, other.freeNodes);
+    return *this;
+}
+
+/**
+ * Make the queue empty, all handles become invalid
+ */
+template <class Comparable>
+void PairingHeap<Comparable>::makeEmpty() {
+    forEachNode(root, [this](Node* n) { freeNode(n); });
+    root = nullptr;
+    count = 0;
+}
+
+/**
+ * Get the smallest element in the queue
+ */
+template <class Comparable>
+const Comparable& PairingHeap<Comparable>::findMin() const {
+    assert(!isEmpty());
+    return root->value;
+}
+
+/**
+ * Remove and return the smallest element in the queue
+ */
+template <class Comparable>
+Comparable PairingHeap<Comparable>::deleteMin() {
+    assert(!isEmpty());
+
+    Node* old = root;
+    Comparable min = std::move(old->value);
+    root = combineSiblings(old->child);
+    freeNode(old);
+    --count;
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isPairingHeap());
+#endif
+
+    return min;
+}
+
+/**
+ * Remove the k smallest elements, or all if fewer, and write them to out in increasing order
+ */
+template <class Comparable>
+template <class OutputIt>
+OutputIt PairingHeap<Comparable>::deleteMin(size_t k, OutputIt out) {
+    for (k = std::min(k, size()); k > 0; --k) {
+        *out++ = deleteMin();
+    }
+    return out;
+}
+
+/**
+ * Add a new element x to the queue
+ */
+template <class Comparable>
+auto PairingHeap<Comparable>::insert(const Comparable& x) -> Handle {
+    return emplace(x);
+}
+
+template <class Comparable>
+auto PairingHeap<Comparable>::insert(Comparable&& x) -> Handle {
+    return emplace(std::move(x));
+}
+
+/**
+ * Add a new element to the queue, constructed in place from args
+ */
+template <class Comparable>
+template <class... Args>
+auto PairingHeap<Comparable>::emplace(Args&&... args) -> Handle {
+    Node* n = newNode(std::forward<Args>(args)...);
+    root = isEmpty() ? n : link(root, n);
+    ++count;
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isPairingHeap());
+#endif
+
+    return n;
+}
+
+/**
+ * Add all elements of the batch to the queue
+ */
+template <class Comparable>
+void PairingHeap<Comparable>::insert_batch(std::span<const Comparable> batch) {
+    for (const Comparable& x : batch) {
+        emplace(x);
+    }
+}
+
+/**
+ * Replace the element with handle h by x, which must not be larger
+ */
+template <class Comparable>
+void PairingHeap<Comparable>::decreaseKey(Handle h, Comparable x) {
+    assert(h != nullptr && !(h->value < x));
+
+    h->value = std::move(x);
+    if (h != root) {
+        // cut the subtree of h from its parent and siblings
+        if (h->prev->child == h) {
+            h->prev->child = h->next;
+        } else {
+            h->prev->next = h->next;
+        }
+        if (h->next != nullptr) {
+            h->next->prev = h->prev;
+        }
+        h->next = h->prev = nullptr;
+        root = link(root, h);
+    }
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isPairingHeap());
+#endif
+}
+
+/**
+ * Move all elements of other into this queue, other becomes empty
+ */
+template <class Comparable>
+void PairingHeap<Comparable>::meld(PairingHeap& other) {
+    if (this == &other || other.isEmpty()) {
+        return;
+    }
+    root = isEmpty() ? other.root : link(root, other.root);
+    count += other.count;
+    other.root = nullptr;
+    other.count = 0;
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isPairingHeap());
+#endif
+}
+
+/**
+ * Remove all elements x such that pred(x) is true
+ */
+template <class Comparable>
+template <class Predicate>
+size_t PairingHeap<Comparable>::remove_if(Predicate pred) {
+    const size_t n = count;
+
+    // the kept nodes become one sibling list, in preorder
+    Node* first = nullptr;
+    Node* last = nullptr;
+    forEachNode(root, [&](Node* node) {
+        if (pred(std::as_const(node->value))) {
+            freeNode(node);
+            --count;
+        } else {
+            node->child = node->next = nullptr;
+            (last != nullptr ? last->next : first) = node;
+            last = node;
+        }
+    });
+    root = combineSiblings(first);
+
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isPairingHeap());
+#endif
+
+    return n - count;
+}
+
+/* ******************* Private member functions ********************* */
+
+/**
+ * Return a node holding a new element constructed from args, reusing a free node if any
+ */
+template <class Comparable>
+template <class... Args>
+auto PairingHeap<Comparable>::newNode(Args&&... args) -> Node* {
+    if (freeNodes == nullptr) {
+        return new Node{Comparable(std::forward<Args>(args)...)};
+    }
+    Node* n = std::exchange(freeNodes, freeNodes->next);
+    n->value = Comparable(std::forward<Args>(args)...);
+    n->child = n->next = n->prev = nullptr;
+    return n;
+}
+
+/**
+ * Add node n to the free nodes
+ */
+template <class Comparable>
+void PairingHeap<Comparable>::freeNode(Node* n) {
+    n->next = freeNodes;
+    freeNodes = n;
+}
+
+/**
+ * Link the trees of roots a and b and return the root of the result
+ * The larger root becomes the first child of the smaller one
+ */
+template <class Comparable>
+auto PairingHeap<Comparable>::link(Node* a, Node* b) -> Node* {
+    if (b->value < a->value) {
+        std::swap(a, b);
+    }
+    b->prev = a;
+    b->next = a->child;
+    if (a->child != nullptr) {
+        a->child->prev = b;
+    }
+    a->child = b;
+    return a;
+}
+
+/**
+ * Link the sibling list starting at first into one tree, in two passes, and return its root
+ */
+template <class Comparable>
+auto PairingHeap<Comparable>::combineSiblings(Node* first) -> Node* {
+    if (first == nullptr) {
+        return nullptr;
+    }
+
+    // first pass: link the siblings pairwise, left to right
+    subtrees.clear();
+    while (first != nullptr) {
+        Node* a = first;
+        Node* b = a->next;
+        first = (b != nullptr) ? b->next : nullptr;
+        a->next = a->prev = nullptr;
+        if (b != nullptr) {
+            b->next = b->prev = nullptr;
+            a = link(a, b);
+        }
+        subtrees.push_back(a);
+    }
+
+    // second pass: link the pairs right to left, into the last one
+    Node* r = subtrees.back();
+    for (size_t i = subtrees.size() - 1; i-- > 0;) {
+        r = link(subtrees[i], r);
+    }
+    return r;
+}
+
+/**
+ * Call f(n) for every node n of the tree of root r, in preorder
+ */
+template <class Comparable>
+template <class F>
+void PairingHeap<Comparable>::forEachNode(Node* r, F f) {
+    std::vector<Node*> stack;
+    if (r != nullptr) {
+        stack.push_back(r);
+    }
+    while (!stack.empty()) {
+        Node* n = stack.back();
+        stack.pop_back();
+        // the root has no siblings
+        if (n != r && n->next != nullptr) {
+            stack.push_back(n->next);
+        }
+        if (n->child != nullptr) {
+            stack.push_back(n->child);
+        }
+        f(n);
+    }
+}
+
+/**
+ * Test whether no node is smaller than its parent and the links are consistent
+ */
+template <class Comparable>
+bool PairingHeap<Comparable>::isPairingHeap() const {
+    if (root == nullptr) {
+        return count == 0;
+    }
+    if (root->prev != nullptr || root->next != nullptr) {
+        return false;
+    }
+
+    size_t n = 0;
+    bool ok = true;
+    forEachNode(root, [&](const Node* node) {
+        ++n;
+        const Node* before = node;
+        for (const Node* c = node->child; c != nullptr; before = c, c = c->next) {
+            if (c->value < node->value || c->prev != before) {
+                ok = false;
+            }
+        }
+    });
+    return ok && n == count;
+}
@@ -0,0 +1,194 @@
+#include <particlesystem/particlestore.h>
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+    #include <immintrin.h>
+#endif
+
+namespace particlesystem {
+
+/**
+ * Set the number of particles to count, new particles are zero
+ * The arrays grow to the next multiple of lanes
+ */
+void ParticleStore::resize(std::size_t count) {
+    const std::size_t padded = (count + lanes - 1) / lanes * lanes;
+    for (Array* a : {&x, &y, &vx, &vy, &radius, &time}) {
+        a->resize(padded, 0.0);
+    }
+    n = count;
+}
+
+/**
+ * Set particle i to particle p, whose velocity changed at time t
+ */
+void ParticleStore::set(std::size_t i, const Particle& p, double t) {
+    x[i] = p.r.x;
+    y[i] = p.r.y;
+    vx[i] = p.v.x;
+    vy[i] = p.v.y;
+    radius[i] = p.radius;
+    time[i] = t;
+}
+
+/**
+ * Add particle i of store from
+ */
+void ParticleStore::push_back(const ParticleStore& from, std::size_t i) {
+    if (n == x.size()) {
+        resize(n + 1);
+    } else {
+        ++n;
+    }
+    const std::size_t k = n - 1;
+    x[k] = from.x[i];
+    y[k] = from.y[i];
+    vx[k] = from.vx[i];
+    vy[k] = from.vy[i];
+    radius[k] = from.radius[i];
+    time[k] = from.time[i];
+}
+
+/**
+ * Compute the time at which particle i collides with each particle of block
+ * The lanes compute the same operations as the scalar loop, in the same order, and the pairs that
+ * do not collide are masked to infinity: dvdr > 0, dvdv == 0, overlapping, d < 0, or in the past
+ */
+void ParticleStore::collisionTimes(std::size_t i, const ParticleStore& block, Array& times) const {
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    times.resize(block.x.size());
+
+#if defined(__AVX512F__)
+    const __m512d ti = _mm512_set1_pd(time[i]);
+    const __m512d xi0 = _mm512_set1_pd(x[i]);
+    const __m512d yi0 = _mm512_set1_pd(y[i]);
+    const __m512d vxi = _mm512_set1_pd(vx[i]);
+    const __m512d vyi = _mm512_set1_pd(vy[i]);
+    const __m512d ri = _mm512_set1_pd(radius[i]);
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d inf = _mm512_set1_pd(infinity);
+    const __m512i sign = _mm512_set1_epi64(std::numeric_limits<long long>::min());
+
+    // max and sqrt are a blend and a masked sqrt: GCC 12 warns that the undefined source operand
+    // of _mm512_max_pd and _mm512_sqrt_pd may be uninitialized
+    for (std::size_t j = 0; j < block.n; j += lanes) {
+        const __m512d tj = _mm512_load_pd(&block.time[j]);
+        const __m512d t = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(ti, tj, _CMP_LT_OQ), ti, tj);
+
+        // positions at t
+        const __m512d xi = _mm512_add_pd(xi0, _mm512_mul_pd(vxi, _mm512_sub_pd(t, ti)));
+        const __m512d yi = _mm512_add_pd(yi0, _mm512_mul_pd(vyi, _mm512_sub_pd(t, ti)));
+        const __m512d vxj = _mm512_load_pd(&block.vx[j]);
+        const __m512d vyj = _mm512_load_pd(&block.vy[j]);
+        const __m512d xj = _mm512_add_pd(_mm512_load_pd(&block.x[j]), _mm512_mul_pd(vxj, _mm512_sub_pd(t, tj)));
+        const __m512d yj = _mm512_add_pd(_mm512_load_pd(&block.y[j]), _mm512_mul_pd(vyj, _mm512_sub_pd(t, tj)));
+
+        const __m512d dx = _mm512_sub_pd(xj, xi);
+        const __m512d dy = _mm512_sub_pd(yj, yi);
+        const __m512d dvx = _mm512_sub_pd(vxj, vxi);
+        const __m512d dvy = _mm512_sub_pd(vyj, vyi);
+
+        const __m512d dvdr = _mm512_add_pd(_mm512_mul_pd(dx, dvx), _mm512_mul_pd(dy, dvy));
+        const __m512d dvdv = _mm512_add_pd(_mm512_mul_pd(dvx, dvx), _mm512_mul_pd(dvy, dvy));
+        const __m512d drdr = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+        const __m512d sigma = _mm512_add_pd(ri, _mm512_load_pd(&block.radius[j]));
+        const __m512d sigma2 = _mm512_mul_pd(sigma, sigma);
+
+        const __m512d d = _mm512_sub_pd(_mm512_mul_pd(dvdr, dvdr), _mm512_mul_pd(dvdv, _mm512_sub_pd(drdr, sigma2)));
+        const __m512d sum = _mm512_add_pd(dvdr, _mm512_mask_sqrt_pd(zero, 0xFF, d));
+        const __m512d dt = _mm512_div_pd(_mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(sum), sign)), dvdv);
+
+        const __mmask8 never = _mm512_cmp_pd_mask(dvdr, zero, _CMP_GT_OQ) | _mm512_cmp_pd_mask(dvdv, zero, _CMP_EQ_OQ) |
+                               _mm512_cmp_pd_mask(drdr, sigma2, _CMP_LT_OQ) | _mm512_cmp_pd_mask(d, zero, _CMP_LT_OQ) |
+                               _mm512_cmp_pd_mask(dt, zero, _CMP_LT_OQ);
+        _mm512_store_pd(&times[j], _mm512_mask_blend_pd(never, _mm512_add_pd(t, dt), inf));
+    }
+#elif defined(__AVX2__)
+    const __m256d ti = _mm256_set1_pd(time[i]);
+    const __m256d xi0 = _mm256_set1_pd(x[i]);
+    const __m256d yi0 = _mm256_set1_pd(y[i]);
+    const __m256d vxi = _mm256_set1_pd(vx[i]);
+    const __m256d vyi = _mm256_set1_pd(vy[i]);
+    const __m256d ri = _mm256_set1_pd(radius[i]);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d inf = _mm256_set1_pd(infinity);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+
+    for (std::size_t j = 0; j < block.n; j += lanes) {
+        const __m256d tj = _mm256_load_pd(&block.time[j]);
+        const __m256d t = _mm256_max_pd(ti, tj);
+
+        // positions at t
+        const __m256d xi = _mm256_add_pd(xi0, _mm256_mul_pd(vxi, _mm256_sub_pd(t, ti)));
+        const __m256d yi = _mm256_add_pd(yi0, _mm256_mul_pd(vyi, _mm256_sub_pd(t, ti)));
+        const __m256d vxj = _mm256_load_pd(&block.vx[j]);
+        const __m256d vyj = _mm256_load_pd(&block.vy[j]);
+        const __m256d xj = _mm256_add_pd(_mm256_load_pd(&block.x[j]), _mm256_mul_pd(vxj, _mm256_sub_pd(t, tj)));
+        const __m256d yj = _mm256_add_pd(_mm256_load_pd(&block.y[j]), _mm256_mul_pd(vyj, _mm256_sub_pd(t, tj)));
+
+        const __m256d dx = _mm256_sub_pd(xj, xi);
+        const __m256d dy = _mm256_sub_pd(yj, yi);
+        const __m256d dvx = _mm256_sub_pd(vxj, vxi);
+        const __m256d dvy = _mm256_sub_pd(vyj, vyi);
+
+        const __m256d dvdr = _mm256_add_pd(_mm256_mul_pd(dx, dvx), _mm256_mul_pd(dy, dvy));
+        const __m256d dvdv = _mm256_add_pd(_mm256_mul_pd(dvx, dvx), _mm256_mul_pd(dvy, dvy));
+        const __m256d drdr = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        const __m256d sigma = _mm256_add_pd(ri, _mm256_load_pd(&block.radius[j]));
+        const __m256d sigma2 = _mm256_mul_pd(sigma, sigma);
+
+        const __m256d d = _mm256_sub_pd(_mm256_mul_pd(dvdr, dvdr), _mm256_mul_pd(dvdv, _mm256_sub_pd(drdr, sigma2)));
+        const __m256d dt = _mm256_div_pd(_mm256_xor_pd(_mm256_add_pd(dvdr, _mm256_sqrt_pd(d)), sign), dvdv);
+
+        __m256d never = _mm256_or_pd(_mm256_cmp_pd(dvdr, zero, _CMP_GT_OQ), _mm256_cmp_pd(dvdv, zero, _CMP_EQ_OQ));
+        never = _mm256_or_pd(never, _mm256_cmp_pd(drdr, sigma2, _CMP_LT_OQ));
+        never = _mm256_or_pd(never, _mm256_cmp_pd(d, zero, _CMP_LT_OQ));
+        never = _mm256_or_pd(never, _mm256_cmp_pd(dt, zero, _CMP_LT_OQ));
+        _mm256_store_pd(&times[j], _mm256_blendv_pd(_mm256_add_pd(t, dt), inf, never));
+    }
+#else
+    for (std::size_t j = 0; j < block.n; ++j) {
+        const double t = std::max(time[i], block.time[j]);
+
+        // positions at t
+        const double xi = x[i] + vx[i] * (t - time[i]);
+        const double yi = y[i] + vy[i] * (t - time[i]);
+        const double xj = block.x[j] + block.vx[j] * (t - block.time[j]);
+        const double yj = block.y[j] + block.vy[j] * (t - block.time[j]);
+
+        const double dx = xj - xi;
+        const double dy = yj - yi;
+        const double dvx = block.vx[j] - vx[i];
+        const double dvy = block.vy[j] - vy[i];
+
+        times[j] = infinity;
+        const double dvdr = dx * dvx + dy * dvy;
+        if (dvdr > 0) {
+            continue;
+        }
+        const double dvdv = dvx * dvx + dvy * dvy;
+        if (dvdv == 0.0) {
+            continue;
+        }
+        const double drdr = dx * dx + dy * dy;
+        const double sigma = radius[i] + block.radius[j];
+        if (drdr < sigma * sigma) {
+            continue;
+        }
+        const double d = (dvdr * dvdr) - dvdv * (drdr - sigma * sigma);
+        if (d < 0.0) {
+            continue;
+        }
+        const double dt = -(dvdr + std::sqrt(d)) / dvdv;
+        if (dt < 0.0) {
+            continue;
+        }
+        times[j] = t + dt;
+    }
+#endif
+}
+
+}  // namespace particlesystem
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+
+#include <particlesystem/particle.h>
+#include <particlesystem/cachealignedallocator.h>
+
+namespace particlesystem {
+
+/**
+ *  The particles of a CollisionSystem as a structure of arrays, one cache aligned array per member,
+ *  so that the collision times of one particle with a block of particles are computed in SIMD lanes:
+ *  8 with AVX-512, 4 with AVX2, and one at a time otherwise
+ *  Only the members read by the predictions are stored, the masses are only needed by the bounces
+ *  The position of a particle is the one at time, when its velocity last changed; it moves in a
+ *  straight line from there
+ *  The arrays are padded to a multiple of lanes, the padding is never a result
+ */
+class ParticleStore {
+public:
+#if defined(__AVX512F__)
+    static constexpr std::size_t lanes = 8;
+#elif defined(__AVX2__)
+    static constexpr std::size_t lanes = 4;
+#else
+    static constexpr std::size_t lanes = 1;
+#endif
+
+    using Array = std::vector<double, CacheAlignedAllocator<double>>;
+
+    /**
+     * Number of particles
+     */
+    std::size_t size() const { return n; }
+
+    /**
+     * Remove all particles, the storage is kept
+     */
+    void clear() { n = 0; }
+
+    /**
+     * Set the number of particles to count, new particles are zero
+     */
+    void resize(std::size_t count);
+
+    /**
+     * Set particle i to particle p, whose velocity changed at time t
+     */
+    void set(std::size_t i, const Particle& p, double t);
+
+    /**
+     * Add particle i of store from
+     */
+    void push_back(const ParticleStore& from, std::size_t i);
+
+    /**
+     * Compute the time at which particle i collides with each particle of block, in times[0, block.size())
+     * Return std::numeric_limits<double>::infinity() as Particle::timeToHit, if they will not collide
+     * A pair is predicted at the later of the times of the two particles, from their positions then,
+     * with the operations of Particle::timeToHit, so that a collision time is the same bits whichever
+     * particle of the pair is i and whenever it is computed
+     */
+    void collisionTimes(std::size_t i, const ParticleStore& block, Array& times) const;
+
+    Array x;  // position at time
+    Array y;
+    Array vx;  // velocity
+    Array vy;
+    Array radius;
+    Array time;  // time of the last change of velocity
+
+private:
+    std::size_t n = 0;  // number of particles, the arrays are padded
+};
+
+}  // namespace particlesystem
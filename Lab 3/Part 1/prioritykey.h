@@ -0,0 +1,19 @@
+#pragma once
+
+#include <type_traits>
+
+/**
+ * Key extractor: the part of a Comparable that orders it, i.e. x < y exactly when key(x) < key(y)
+ * A number is its own key, other types are ordered by their scheduledTime(), e.g. Event
+ * Specialize PriorityKey for other types
+ */
+template <class Comparable>
+struct PriorityKey {
+    static auto key(const Comparable& x) {
+        if constexpr (std::is_arithmetic_v<Comparable>) {
+            return x;
+        } else {
+            return x.scheduledTime();
+        }
+    }
+};
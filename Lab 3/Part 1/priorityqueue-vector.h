@@ -2,20 +2,23 @@
 
 #include <iostream>
 #include <vector>
+#include <span>
+#include <utility>
 #include <algorithm>
 #include <cassert>
 
 /**
  * A priority queue implemented as a decreasingly sorted vector
  * the smallest element is at the end of the vector
+ * deleteMin is O(1), but insert moves O(n) elements
  */
 template <class Comparable>
-class PriorityQueue {
+class SortedVectorQueue {
 public:
     /**
      * Constructor to create a queue with the given capacity
      */
-    explicit PriorityQueue(int initCapacity = 100) {
+    explicit SortedVectorQueue(int initCapacity = 100) {
         pq.reserve(initCapacity);
         makeEmpty();
         assert(isEmpty());
@@ -24,11 +27,11 @@ public:
     /**
      * Constructor to initialize a priority queue based on a given vector V
      */
-    explicit PriorityQueue(const std::vector<Comparable>& V) : pq{V} { heapify(); }
+    explicit SortedVectorQueue(const std::vector<Comparable>& V) : pq{V} { heapify(); }
 
     // Disable copying
-    PriorityQueue(const PriorityQueue&) = delete;
-    PriorityQueue& operator=(const PriorityQueue&) = delete;
+    SortedVectorQueue(const SortedVectorQueue&) = delete;
+    SortedVectorQueue& operator=(const SortedVectorQueue&) = delete;
 
     /**
      * Make the queue empty
@@ -59,7 +62,7 @@ public:
      */
     Comparable deleteMin() {
         assert(!isEmpty());
-        Comparable x = pq.back();
+        Comparable x = std::move(pq.back());
         pq.pop_back();
         return x;
     }
@@ -67,9 +70,39 @@ public:
     /**
      * Add a new element x to the queue
      */
-    void insert(const Comparable& x) {
-        pq.push_back(x);
-        heapify();
+    void insert(const Comparable& x) { emplace(x); }
+
+    void insert(Comparable&& x) { emplace(std::move(x)); }
+
+    /**
+     * Add a new element to the queue, constructed in place from args
+     * The element is moved to its place, the queue stays sorted -- O(n)
+     */
+    template <class... Args>
+    void emplace(Args&&... args) {
+        pq.emplace_back(std::forward<Args>(args)...);
+        std::rotate(std::upper_bound(pq.begin(), pq.end() - 1, pq.back(), std::greater<Comparable>()),
+                    pq.end() - 1, pq.end());
+    }
+
+    /**
+     * Add all elements of the batch to the queue
+     * The batch is sorted and merged with the queue -- O(k log k + n)
+     */
+    void insert_batch(std::span<const Comparable> batch) {
+        const auto middle = pq.insert(pq.end(), batch.begin(), batch.end());
+        std::sort(middle, pq.end(), std::greater<Comparable>());
+        std::inplace_merge(pq.begin(), middle, pq.end(), std::greater<Comparable>());
+    }
+
+    /**
+     * Remove all elements x such that pred(x) is true
+     * The remaining elements stay sorted -- O(n)
+     * Return the number of removed elements
+     */
+    template <class Predicate>
+    size_t remove_if(Predicate pred) {
+        return std::erase_if(pq, pred);
     }
 
 private:
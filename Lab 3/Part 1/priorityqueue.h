@@ -2,15 +2,42 @@
 
 #include <iostream>
 #include <vector>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <bit>
 #include <cassert>
 
+#include <particlesystem/cachealignedallocator.h>
+#include <particlesystem/queuestats.h>
+
 //#define TEST_PRIORITY_QUEUE
+//#define PRIORITY_QUEUE_STATS
+
+#ifdef PRIORITY_QUEUE_STATS
+using DefaultQueueStats = QueueStats;
+#else
+using DefaultQueueStats = NoQueueStats;
+#endif
 
 /**
  * A heap based priority queue where the root is the smallest element -- min heap
+ *
+ * Each node has Arity children (2, 4, or 8): a wider heap is shallower, so deleteMin moves
+ * fewer elements, but compares more children per level
+ * The heap is 0-based: the children of node i are Arity * i + 1, ..., Arity * i + Arity
+ * Arity - 1 unused slots precede the root in the cache-aligned storage, so that the children of
+ * a node start at a multiple of Arity, i.e. a group of children does not straddle more cache lines
+ * than needed (one, if Arity * sizeof(Comparable) <= 64)
+ *
+ * Stats is the statistics policy, see queuestats.h: QueueStats counts inserts, deleteMins, comparisons,
+ * moves, and percolation depths, NoQueueStats compiles to nothing; the default is NoQueueStats,
+ * or QueueStats if PRIORITY_QUEUE_STATS is defined
  */
-template <class Comparable>
+template <class Comparable, int Arity = 4, class Stats = DefaultQueueStats>
 class PriorityQueue {
+    static_assert(Arity == 2 || Arity == 4 || Arity == 8, "Arity must be 2, 4, or 8");
+
 public:
     /**
      * Constructor to create a queue with the given capacity
@@ -49,21 +76,83 @@ public:
 
     /**
      * Remove and return the smallest element in the queue
+     * The element is moved out of the queue, not copied
      */
     Comparable deleteMin();
 
+    /**
+     * Remove the k smallest elements, or all if fewer, and write them to out in increasing order
+     * Return the end of the written range
+     * A large k selects, sorts, and removes the k smallest at once and rebuilds the heap bottom-up,
+     * O(n + k log k), a small one deletes them one by one, O(k log n)
+     */
+    template <class OutputIt>
+    OutputIt deleteMin(size_t k, OutputIt out);
+
     /**
      * Add a new element x to the queue
      */
     void insert(const Comparable& x);
 
+    /**
+     * Add a new element x to the queue, moved into the queue
+     */
+    void insert(Comparable&& x);
+
+    /**
+     * Add a new element to the queue, constructed in place from args
+     */
+    template <class... Args>
+    void emplace(Args&&... args);
+
+    /**
+     * Add all elements of the batch to the queue
+     * A batch at least as large as the queue is appended and the whole heap rebuilt bottom-up, O(n + k)
+     * Otherwise each element is percolated up, O(k) on average and O(k log(n + k)) in the worst case
+     */
+    void insert_batch(std::span<const Comparable> batch);
+
+    /**
+     * Remove all elements x such that pred(x) is true
+     * The remaining elements are compacted in one pass and the heap rebuilt bottom-up -- O(n)
+     * Return the number of removed elements
+     */
+    template <class Predicate>
+    size_t remove_if(Predicate pred);
+
+    /**
+     * Get the statistics of the queue, since its construction
+     */
+    const Stats& stats() const { return stats_; }
+
 private:
-    std::vector<Comparable> pq;
+    static constexpr int offset = Arity - 1;  // number of unused slots before the root
+
+    std::vector<Comparable, CacheAlignedAllocator<Comparable>> pq;  // root is pq[offset]
+    [[no_unique_address]] Stats stats_;
+
+    /**
+     * Node i of the heap, 0-based
+     */
+    Comparable& node(int i) { return pq[i + offset]; }
+    const Comparable& node(int i) const { return pq[i + offset]; }
+
+    static int parent(int i) { return (i - 1) / Arity; }
+    static int firstChild(int i) { return Arity * i + 1; }
 
     // Auxiliary member functions
 
+    /**
+     * Compare two elements, counted by the statistics
+     */
+    bool less(const Comparable& a, const Comparable& b) {
+        stats_.compare();
+        return a < b;
+    }
+
     /**
      * Restore the heap property
+     * Floyd's bottom-up construction: percolate down every internal node, from the last one -- O(n)
      */
     void heapify();
 
@@ -72,9 +161,17 @@ private:
      */
     bool isMinHeap() const;
 
-    void percolateUp(int x);
+    /**
+     * Move the element at position hole up to its place
+     * Larger parents are moved down into the hole and the element is placed once
+     */
+    void percolateUp(int hole);
 
-    void percolateDown(int x);
+    /**
+     * Move the element at position hole down to its place
+     * Smaller children are moved up into the hole and the element is placed once
+     */
+    void percolateDown(int hole);
 };
 
 /* *********************** Member functions implementation *********************** */
@@ -82,13 +179,13 @@ private:
 /**
  * Constructor to create a queue with the given capacity
  */
-template <class Comparable>
-PriorityQueue<Comparable>::PriorityQueue(int initCapacity) {
+template <class Comparable, int Arity, class Stats>
+PriorityQueue<Comparable, Arity, Stats>::PriorityQueue(int initCapacity) {
     /*
      * ADD CODE HERE
      */
 
-    pq.reserve(initCapacity);
+    pq.reserve(initCapacity + offset);
     makeEmpty();
 
     assert(isEmpty());  // do not remove this line
@@ -97,10 +194,18 @@ PriorityQueue<Comparable>::PriorityQueue(int initCapacity) {
 /**
  * Constructor to initialize a priority queue based on a given vector V
  */
-template <class Comparable>
-PriorityQueue<Comparable>::PriorityQueue(const std::vector<Comparable>& V) : pq{V} {
+template <class Comparable, int Arity, class Stats>
+PriorityQueue<Comparable, Arity, Stats>::PriorityQueue(const std::vector<Comparable>& V) {
     // Implementation is provided for you
-    heapify();
+    pq.reserve(V.size() + offset);
+    makeEmpty();
+    pq.insert(pq.end(), V.begin(), V.end());
+    for (size_t i = 1; i <= V.size(); ++i) {
+        stats_.insert(i);
+    }
+    if (!isEmpty()) {
+        heapify();
+    }
 #ifdef TEST_PRIORITY_QUEUE
     assert(isMinHeap());
 #endif
@@ -109,72 +214,75 @@ PriorityQueue<Comparable>::PriorityQueue(const std::vector<Comparable>& V) : pq{
 /**
  * Make the queue empty
  */
-template <class Comparable>
-void PriorityQueue<Comparable>::makeEmpty() {
+template <class Comparable, int Arity, class Stats>
+void PriorityQueue<Comparable, Arity, Stats>::makeEmpty() {
     /*
      * ADD CODE HERE
      */
 
     pq.clear();
-    pq.push_back(Comparable{});
+    pq.resize(offset);  // unused slots
 }
 
 /**
  * Check is the queue is empty
  * Return true if the queue is empty, false otherwise
  */
-template <class Comparable>
-bool PriorityQueue<Comparable>::isEmpty() const {
+template <class Comparable, int Arity, class Stats>
+bool PriorityQueue<Comparable, Arity, Stats>::isEmpty() const {
     /*
      * ADD CODE HERE
      */
 
-    return pq.size() == 1;  // replace this line by the correct return value
+    return pq.size() == offset;  // replace this line by the correct return value
 }
 
 /**
  * Get the size of the queue, i.e. number of elements in the queue
  */
-template <class Comparable>
-size_t PriorityQueue<Comparable>::size() const {
+template <class Comparable, int Arity, class Stats>
+size_t PriorityQueue<Comparable, Arity, Stats>::size() const {
     /*
      * ADD CODE HERE
      */
 
-    return pq.size() - 1;  // replace this line by the correct return value
+    return pq.size() - offset;  // replace this line by the correct return value
 }
 
 /**
  * Get the smallest element in the queue
  */
-template <class Comparable>
-Comparable PriorityQueue<Comparable>::findMin() {
+template <class Comparable, int Arity, class Stats>
+Comparable PriorityQueue<Comparable, Arity, Stats>::findMin() {
     assert(isEmpty() == false);  // do not remove this line
     /*
      * ADD CODE HERE
      */
 
-    return pq[1];  // Comparable{};  // replace this line by the correct return value
+    return node(0);  // Comparable{};  // replace this line by the correct return value
 }
 
 /**
  * Remove and return the smallest element in the queue
  */
-template <class Comparable>
-Comparable PriorityQueue<Comparable>::deleteMin() {
+template <class Comparable, int Arity, class Stats>
+Comparable PriorityQueue<Comparable, Arity, Stats>::deleteMin() {
     assert(!isEmpty());  // do not remove this line
 
     /*
      * ADD CODE HERE
      */
 
-    Comparable min = findMin();
-    pq[1] = pq[pq.size() - 1];
+    Comparable min = std::move(node(0));
+    if (size() > 1) {
+        node(0) = std::move(pq.back());
+        stats_.move();
+    }
     pq.pop_back();
-    if (pq.size() > 1) {
-    percolateDown(1);
+    stats_.deleteMin();
+    if (!isEmpty()) {
+        percolateDown(0);
     }
-    
 
     // Do not remove this code block
 #ifdef TEST_PRIORITY_QUEUE
@@ -184,17 +292,73 @@ Comparable PriorityQueue<Comparable>::deleteMin() {
     return min;  // Comparable{};  // replace this line by the correct return value
 }
 
+/**
+ * Remove the k smallest elements, or all if fewer, and write them to out in increasing order
+ */
+template <class Comparable, int Arity, class Stats>
+template <class OutputIt>
+OutputIt PriorityQueue<Comparable, Arity, Stats>::deleteMin(size_t k, OutputIt out) {
+    const size_t n = size();
+    k = std::min(k, n);
+
+    // k deleteMin take about k log2(n) percolation steps, selection and rebuilding a few times n
+    if (k * std::bit_width(n) < 4 * n) {
+        for (; k > 0; --k) {
+            *out++ = deleteMin();
+        }
+        return out;
+    }
+
+    const auto first = pq.begin() + offset;
+    const auto compare = [this](const Comparable& a, const Comparable& b) { return less(a, b); };
+    std::nth_element(first, first + k, pq.end(), compare);
+    std::sort(first, first + k, compare);
+    out = std::move(first, first + k, out);
+    for (size_t i = 0; i < k; ++i) {
+        stats_.deleteMin();
+    }
+    pq.erase(first, first + k);
+    if (!isEmpty()) {
+        heapify();
+    }
+
+    // Do not remove this code block
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+
+    return out;
+}
+
 /**
  * Add a new element x to the queue
  */
-template <class Comparable>
-void PriorityQueue<Comparable>::insert(const Comparable& x) {
+template <class Comparable, int Arity, class Stats>
+void PriorityQueue<Comparable, Arity, Stats>::insert(const Comparable& x) {
     /*
      * ADD CODE HERE
      */
 
-    pq.push_back(x);
-    percolateUp(pq.size() - 1);
+    emplace(x);
+}
+
+/**
+ * Add a new element x to the queue, moved into the queue
+ */
+template <class Comparable, int Arity, class Stats>
+void PriorityQueue<Comparable, Arity, Stats>::insert(Comparable&& x) {
+    emplace(std::move(x));
+}
+
+/**
+ * Add a new element to the queue, constructed in place from args
+ */
+template <class Comparable, int Arity, class Stats>
+template <class... Args>
+void PriorityQueue<Comparable, Arity, Stats>::emplace(Args&&... args) {
+    pq.emplace_back(std::forward<Args>(args)...);
+    stats_.insert(size());
+    percolateUp(static_cast<int>(size()) - 1);
 
     // Do not remove this code block
 #ifdef TEST_PRIORITY_QUEUE
@@ -202,42 +366,92 @@ void PriorityQueue<Comparable>::insert(const Comparable& x) {
 #endif
 }
 
+/**
+ * Add all elements of the batch to the queue
+ */
+template <class Comparable, int Arity, class Stats>
+void PriorityQueue<Comparable, Arity, Stats>::insert_batch(std::span<const Comparable> batch) {
+    const size_t n = size();
+    const size_t k = batch.size();
+
+    // rebuilding takes less than 2(n + k) comparisons, percolating up about 2.6 per element
+    // on average, since most elements stop near the leaves
+    const bool rebuild = k >= n;
+
+    if (rebuild) {
+        pq.insert(pq.end(), batch.begin(), batch.end());
+        for (size_t i = n + 1; i <= n + k; ++i) {
+            stats_.insert(i);
+        }
+        if (!isEmpty()) {
+            heapify();
+        }
+    } else {
+        for (const Comparable& x : batch) {
+            pq.push_back(x);
+            stats_.insert(size());
+            percolateUp(static_cast<int>(size()) - 1);
+        }
+    }
+
+    // Do not remove this code block
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+}
+
+/**
+ * Remove all elements x such that pred(x) is true
+ */
+template <class Comparable, int Arity, class Stats>
+template <class Predicate>
+size_t PriorityQueue<Comparable, Arity, Stats>::remove_if(Predicate pred) {
+    const auto last = std::remove_if(pq.begin() + offset, pq.end(), pred);
+    const size_t removed = pq.end() - last;
+    pq.erase(last, pq.end());
+    if (removed > 0 && !isEmpty()) {
+        heapify();
+    }
+
+    // Do not remove this code block
+#ifdef TEST_PRIORITY_QUEUE
+    assert(isMinHeap());
+#endif
+
+    return removed;
+}
+
 /* ******************* Private member functions ********************* */
 
 /**
  * Restore the heap property
  */
-template <class Comparable>
-void PriorityQueue<Comparable>::heapify() {
-    assert(pq.size() > 1);  // do not remove this line
+template <class Comparable, int Arity, class Stats>
+void PriorityQueue<Comparable, Arity, Stats>::heapify() {
+    assert(!isEmpty());  // do not remove this line
 
     /*
      * ADD CODE HERE
      */
 
-    for (int i = (pq.size() - 1) / 2; i >= 1; --1) {
-        percolateDown(pq, i);
+    for (int i = parent(static_cast<int>(size()) - 1); i >= 0; --i) {
+        percolateDown(i);
     }
-        
 }
 
 /**
  * Test whether pq is a min heap
  */
-template <class Comparable>
-bool PriorityQueue<Comparable>::isMinHeap() const {
+template <class Comparable, int Arity, class Stats>
+bool PriorityQueue<Comparable, Arity, Stats>::isMinHeap() const {
     /*
      * ADD CODE HERE
     */
 
-    int size = pq.size() - 1;
-
-    for (int i = 1; i <= size / 2; ++i) {
-        int left = 2 * i;
-        int right = 2 * i + 1;
+    const int n = static_cast<int>(size());
 
-        if (left <= size && pq[i] > pq[left]) return false;
-        if (right <= size && pq[i] > pq[right]) return false;
+    for (int child = 1; child < n; ++child) {
+        if (node(child) < node(parent(child))) return false;
     }
 
     return true;  // replace this line by the correct return value
@@ -246,27 +460,44 @@ bool PriorityQueue<Comparable>::isMinHeap() const {
 /**
  * Function to percolate up node
  */
-template <class Comparable>
-void PriorityQueue<Comparable>::percolateUp(int index) {
-    while (index > 1 && pq[index] < pq[index / 2]) {
-        std::swap(pq[index], pq[index / 2]);
-        index /= 2;
+template <class Comparable, int Arity, class Stats>
+void PriorityQueue<Comparable, Arity, Stats>::percolateUp(int hole) {
+    Comparable x = std::move(node(hole));
+    int depth = 0;
+    while (hole > 0 && less(x, node(parent(hole)))) {
+        node(hole) = std::move(node(parent(hole)));
+        stats_.move();
+        hole = parent(hole);
+        ++depth;
     }
+    node(hole) = std::move(x);
+    stats_.percolateUp(depth);
 }
 
 /**
  * Function to percolate down node
  */
-template <class Comparable>
-void PriorityQueue<Comparable>::percolateDown(int index) {
-    int size = pq.size() - 1;
-    while (2 * index <= size) {
-        int child = 2 * index;
-        if (child + 1 <= size && pq[child + 1] < pq[child]) child++;
-
-        if (pq[index] <= pq[child]) break;
-
-        std::swap(pq[index], pq[child]);
-        index = child;
+template <class Comparable, int Arity, class Stats>
+void PriorityQueue<Comparable, Arity, Stats>::percolateDown(int hole) {
+    const int n = static_cast<int>(size());
+    Comparable x = std::move(node(hole));
+    int depth = 0;
+    while (firstChild(hole) < n) {
+        // smallest child: the group of children is contiguous, in one cache line for small elements
+        const int first = firstChild(hole);
+        const int last = (first + Arity <= n) ? first + Arity : n;
+        int child = first;
+        for (int c = first + 1; c < last; ++c) {
+            if (less(node(c), node(child))) child = c;
+        }
+
+        if (!less(node(child), x)) break;
+
+        node(hole) = std::move(node(child));
+        stats_.move();
+        hole = child;
+        ++depth;
     }
+    node(hole) = std::move(x);
+    stats_.percolateDown(depth);
 }
\ No newline at end of file
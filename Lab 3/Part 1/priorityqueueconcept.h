@@ -0,0 +1,21 @@
+#pragma once
+
+#include <concepts>
+#include <utility>
+#include <cstddef>
+
+/**
+ * The operations of a min priority queue of Comparable, as provided by PriorityQueue
+ * and the other queues of this directory, e.g. PairingHeap, BHeap, and CalendarQueue
+ * Code generic over the queue, e.g. CollisionSystem::simulate, requires this concept
+ */
+template <class Queue, class Comparable>
+concept MinPriorityQueue = requires(Queue q, const Queue cq, const Comparable& x, Comparable&& y) {
+    q.makeEmpty();
+    { cq.isEmpty() } -> std::convertible_to<bool>;
+    { cq.size() } -> std::convertible_to<std::size_t>;
+    { q.findMin() } -> std::convertible_to<Comparable>;
+    { q.deleteMin() } -> std::convertible_to<Comparable>;
+    q.insert(x);
+    q.insert(std::move(y));
+};
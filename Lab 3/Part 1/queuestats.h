@@ -0,0 +1,91 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Statistics policies of PriorityQueue, given as its Stats template parameter
+ * PriorityQueue calls the member functions of its policy on its hot paths:
+ *   insert(size), deleteMin():  an element was inserted, the queue has now size elements, or deleted
+ *   compare():                  two elements were compared
+ *   move():                     an element was moved to another position of the queue
+ *   percolateUp(depth),
+ *   percolateDown(depth):       an element was percolated depth levels up or down
+ */
+
+/**
+ * Policy that collects nothing: the calls are empty and inlined, and the member takes no space,
+ * so that PriorityQueue compiles to the same code as without statistics
+ */
+struct NoQueueStats {
+    static constexpr bool enabled = false;
+
+    void insert(std::size_t) {}
+    void deleteMin() {}
+    void compare() {}
+    void move() {}
+    void percolateUp(int) {}
+    void percolateDown(int) {}
+};
+
+/**
+ * Policy that counts the operations of the queue, readable at any time and exportable as JSON
+ */
+struct QueueStats {
+    static constexpr bool enabled = true;
+
+    static constexpr int maxDepth = 32;  // deeper percolations are counted as maxDepth - 1
+
+    std::size_t peakSize = 0;
+    std::size_t inserts = 0;
+    std::size_t deleteMins = 0;
+    std::size_t comparisons = 0;
+    std::size_t moves = 0;
+    std::array<std::size_t, maxDepth> percolateUpDepths{};    // number of percolations up by depth
+    std::array<std::size_t, maxDepth> percolateDownDepths{};  // number of percolations down by depth
+
+    void insert(std::size_t size) {
+        ++inserts;
+        peakSize = std::max(peakSize, size);
+    }
+
+    void deleteMin() { ++deleteMins; }
+    void compare() { ++comparisons; }
+    void move() { ++moves; }
+    void percolateUp(int depth) { ++percolateUpDepths[std::min(depth, maxDepth - 1)]; }
+    void percolateDown(int depth) { ++percolateDownDepths[std::min(depth, maxDepth - 1)]; }
+
+    /**
+     * Reset all counters
+     */
+    void reset() { *this = QueueStats{}; }
+
+    /**
+     * Return the statistics as a JSON object, on one line
+     * The depth histograms end at the largest depth that occurred
+     */
+    std::string toJson() const {
+        std::ostringstream os;
+        os << "{\"peakSize\":" << peakSize << ",\"inserts\":" << inserts << ",\"deleteMins\":" << deleteMins
+           << ",\"comparisons\":" << comparisons << ",\"moves\":" << moves << ",\"percolateUpDepths\":";
+        writeHistogram(os, percolateUpDepths);
+        os << ",\"percolateDownDepths\":";
+        writeHistogram(os, percolateDownDepths);
+        os << '}';
+        return os.str();
+    }
+
+private:
+    static void writeHistogram(std::ostream& os, const std::array<std::size_t, maxDepth>& counts) {
+        const auto end = std::find_if(counts.rbegin(), counts.rend(), [](std::size_t n) { return n != 0; }).base();
+        os << '[';
+        for (auto it = counts.begin(); it != end; ++it) {
+            os << (it == counts.begin() ? "" : ",") << *it;
+        }
+        os << ']';
+    }
+};
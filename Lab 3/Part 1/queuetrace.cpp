@@ -0,0 +1,138 @@
+#include <particlesystem/queuetrace.h>
+
+#include <cstring>
+
+namespace particlesystem {
+
+namespace {
+
+constexpr char magic[8] = {'P', 'Q', 'T', 'R', 'A', 'C', 'E', '1'};
+
+/**
+ * Help function to write the elements of V, preceded by their number
+ */
+template <class T>
+void writeArray(std::ostream& os, const std::vector<T>& V) {
+    const std::uint64_t n = V.size();
+    os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    os.write(reinterpret_cast<const char*>(V.data()), static_cast<std::streamsize>(n * sizeof(T)));
+}
+
+/**
+ * Help function to read the elements of V, preceded by their number
+ * The size is checked against the remaining input before allocating
+ */
+template <class T>
+bool readArray(std::istream& is, std::vector<T>& V) {
+    std::uint64_t n = 0;
+    if (!is.read(reinterpret_cast<char*>(&n), sizeof(n))) {
+        return false;
+    }
+
+    const auto here = is.tellg();
+    is.seekg(0, std::ios::end);
+    const auto end = is.tellg();
+    is.seekg(here);
+    if (here < 0 || end < 0 || n > static_cast<std::uint64_t>(end - here) / sizeof(T)) {
+        return false;
+    }
+
+    V.resize(n);
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(V.data()), static_cast<std::streamsize>(n * sizeof(T))));
+}
+
+}  // namespace
+
+/**
+ * Record the insertion of a batch of events
+ */
+void QueueTrace::insert(std::span<const Event> batch) {
+    if (batch.empty()) {
+        return;
+    }
+    operations_.push_back({Op::insert_batch, static_cast<std::uint32_t>(batch.size())});
+    for (const Event& e : batch) {
+        inserted_.push_back(e.scheduledTime());
+    }
+}
+
+/**
+ * Record the deletion of event e, the smallest
+ */
+void QueueTrace::deleteMin(const Event& e) {
+    if (operations_.empty() || operations_.back().op != Op::deleteMin) {
+        operations_.push_back({Op::deleteMin, 0});
+    }
+    ++operations_.back().count;
+    deleted_.push_back(e.scheduledTime());
+}
+
+/**
+ * Record the removal of event e by the current purge
+ */
+void QueueTrace::remove(const Event& e) {
+    removed_.push_back(e.scheduledTime());
+    ++pendingRemovals_;
+}
+
+/**
+ * Record the end of a purge
+ */
+void QueueTrace::purge() {
+    operations_.push_back({Op::purge, static_cast<std::uint32_t>(pendingRemovals_)});
+    pendingRemovals_ = 0;
+}
+
+/**
+ * Remove all operations
+ */
+void QueueTrace::clear() {
+    operations_.clear();
+    inserted_.clear();
+    deleted_.clear();
+    removed_.clear();
+    pendingRemovals_ = 0;
+}
+
+/**
+ * Write the trace to stream os in the binary format
+ */
+void QueueTrace::write(std::ostream& os) const {
+    os.write(magic, sizeof(magic));
+    writeArray(os, operations_);
+    writeArray(os, inserted_);
+    writeArray(os, deleted_);
+    writeArray(os, removed_);
+}
+
+/**
+ * Read a trace in the binary format from stream is
+ */
+QueueTrace QueueTrace::read(std::istream& is) {
+    QueueTrace trace;
+    char header[sizeof(magic)];
+    if (!is.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0 ||
+        !readArray(is, trace.operations_) || !readArray(is, trace.inserted_) || !readArray(is, trace.deleted_) ||
+        !readArray(is, trace.removed_) || !trace.isConsistent()) {
+        is.setstate(std::ios::failbit);
+        return QueueTrace{};
+    }
+    return trace;
+}
+
+/**
+ * Test whether the counts of the operations match the recorded times
+ */
+bool QueueTrace::isConsistent() const {
+    std::uint64_t counts[3] = {0, 0, 0};
+    for (const Operation& op : operations_) {
+        const auto i = static_cast<std::uint32_t>(op.op);
+        if (i > 2) {
+            return false;
+        }
+        counts[i] += op.count;
+    }
+    return counts[0] == inserted_.size() && counts[1] == deleted_.size() && counts[2] == removed_.size();
+}
+
+}  // namespace particlesystem
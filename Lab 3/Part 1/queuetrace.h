@@ -0,0 +1,89 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include <particlesystem/event.h>
+
+namespace particlesystem {
+
+/**
+ * The sequence of operations on the priority queue of a simulation, recorded by
+ * CollisionSystem::simulate when its trace is set, to be replayed on other queues
+ *
+ * Only the times of the events are recorded: the queues order the events by time only
+ *   insert_batch:  the times of the inserted events
+ *   deleteMin:     the times of the deleted events, consecutive deleteMin are one operation
+ *   purge:         the times of the events removed by remove_if
+ *
+ * Binary format, in the byte order of the machine:
+ *   magic "PQTRACE1", then the operations, the inserted times, the deleted times, and
+ *   the removed times, each as a 64-bit count followed by the elements
+ */
+class QueueTrace {
+public:
+    enum class Op : std::uint32_t { insert_batch, deleteMin, purge };
+
+    struct Operation {
+        Op op;
+        std::uint32_t count;  // number of inserted, deleted, or removed events
+    };
+
+    /**
+     * Record the insertion of a batch of events
+     */
+    void insert(std::span<const Event> batch);
+
+    /**
+     * Record the deletion of event e, the smallest
+     */
+    void deleteMin(const Event& e);
+
+    /**
+     * Record the removal of event e by the current purge
+     */
+    void remove(const Event& e);
+
+    /**
+     * Record the end of a purge, i.e. of the removals since the previous operation
+     */
+    void purge();
+
+    /**
+     * Remove all operations
+     */
+    void clear();
+
+    const std::vector<Operation>& operations() const { return operations_; }
+    const std::vector<double>& insertedTimes() const { return inserted_; }
+    const std::vector<double>& deletedTimes() const { return deleted_; }
+    const std::vector<double>& removedTimes() const { return removed_; }
+
+    /**
+     * Write the trace to stream os in the binary format
+     * os should be opened in binary mode
+     */
+    void write(std::ostream& os) const;
+
+    /**
+     * Read a trace in the binary format from stream is
+     * The stream failbit is set if the input is not valid
+     */
+    static QueueTrace read(std::istream& is);
+
+private:
+    std::vector<Operation> operations_;
+    std::vector<double> inserted_;
+    std::vector<double> deleted_;
+    std::vector<double> removed_;
+    size_t pendingRemovals_ = 0;  // removals of the current purge
+
+    /**
+     * Test whether the counts of the operations match the recorded times
+     */
+    bool isConsistent() const;
+};
+
+}  // namespace particlesystem